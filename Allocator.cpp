@@ -0,0 +1,155 @@
+#include "Allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	char* alignUp(char* ptr, std::size_t alignment)
+	{
+		const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+		return ptr + ((alignment - address % alignment) % alignment);
+	}
+}
+
+namespace swift
+{
+	constexpr std::size_t Allocator::defaultChunkSize;
+
+	Allocator::Allocator()
+	:	Allocator(defaultChunkSize)
+	{}
+
+	Allocator::Allocator(std::size_t chunkSize)
+	:	chunkSize(chunkSize),
+		first(nullptr),
+		current(nullptr),
+		cursor(nullptr),
+		limit(nullptr),
+		latest(nullptr),
+		usedBytes(0),
+		capacityBytes(0)
+	{}
+
+	Allocator::~Allocator()
+	{
+		while(first)
+		{
+			Chunk* next = first->next;
+			::operator delete(first);
+			first = next;
+		}
+	}
+
+	void* Allocator::allocate(std::size_t bytes, std::size_t alignment)
+	{
+		char* ptr = cursor ? alignUp(cursor, alignment) : nullptr;
+
+		if(!ptr || ptr > limit || bytes > static_cast<std::size_t>(limit - ptr))
+		{
+			nextChunk(bytes, alignment);
+			ptr = alignUp(cursor, alignment);
+		}
+
+		cursor = ptr + bytes;
+		latest = ptr;
+		usedBytes += bytes;
+
+		return ptr;
+	}
+
+	void Allocator::deallocate(void* ptr, std::size_t bytes)
+	{
+		if(ptr && ptr == latest)
+		{
+			cursor = latest;
+			latest = nullptr;
+			usedBytes -= bytes;
+		}
+	}
+
+	void* Allocator::reallocate(void* ptr, std::size_t oldBytes, std::size_t newBytes, std::size_t alignment)
+	{
+		char* block = static_cast<char*>(ptr);
+
+		if(block && block == latest && newBytes <= static_cast<std::size_t>(limit - block))
+		{
+			cursor = block + newBytes;
+			usedBytes = usedBytes - oldBytes + newBytes;
+			return block;
+		}
+
+		void* moved = allocate(newBytes, alignment);
+
+		if(block)
+			std::memcpy(moved, block, std::min(oldBytes, newBytes));
+
+		return moved;
+	}
+
+	void Allocator::reset()
+	{
+		current = first;
+		cursor = first ? first->begin() : nullptr;
+		limit = first ? first->end() : nullptr;
+		latest = nullptr;
+		usedBytes = 0;
+	}
+
+	std::size_t Allocator::used() const
+	{
+		return usedBytes;
+	}
+
+	std::size_t Allocator::capacity() const
+	{
+		return capacityBytes;
+	}
+
+	char* Allocator::Chunk::begin()
+	{
+		return reinterpret_cast<char*>(this) + sizeof(Chunk);
+	}
+
+	char* Allocator::Chunk::end()
+	{
+		return reinterpret_cast<char*>(this) + size;
+	}
+
+	void Allocator::nextChunk(std::size_t bytes, std::size_t alignment)
+	{
+		// room for the header, and for aligning wherever the chunk happens to start
+		if(bytes > std::numeric_limits<std::size_t>::max() - sizeof(Chunk) - alignment)
+			throw std::bad_alloc();
+
+		const std::size_t needed = sizeof(Chunk) + bytes + alignment;
+
+		Chunk* next = current ? current->next : first;
+
+		// chunks kept from before a reset get used again first, but a chunk that's too small is skipped over
+		// by putting the new one in front of it, so it's still there for the next round
+		if(!next || next->size < needed)
+		{
+			const std::size_t size = std::max(chunkSize, needed);
+
+			Chunk* chunk = static_cast<Chunk*>(::operator new(size));
+			chunk->size = size;
+			chunk->next = next;
+
+			if(current)
+				current->next = chunk;
+			else
+				first = chunk;
+
+			capacityBytes += size;
+			next = chunk;
+		}
+
+		current = next;
+		cursor = current->begin();
+		limit = current->end();
+		latest = nullptr;
+	}
+}
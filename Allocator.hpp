@@ -1,8 +1,182 @@
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
 namespace swift
 {
+	// a monotonic arena: allocating bumps a pointer through big chunks, and nothing is freed on its own
+	// everything is freed at once by reset(), which keeps the chunks around for the next round
+	// for scratch memory with an obvious end (a frame, a request), where malloc's per-object bookkeeping is wasted
+	// not thread safe
 	class Allocator
 	{
 		public:
+			static constexpr std::size_t defaultChunkSize = 64 * 1024;
+
 			Allocator();
+
+			// chunks are at least "chunkSize" bytes, bigger when an allocation needs it
+			explicit Allocator(std::size_t chunkSize);
+
+			Allocator(const Allocator&) = delete;
+			Allocator& operator =(const Allocator&) = delete;
+
+			~Allocator();
+
+			// throws std::bad_alloc if a new chunk is needed and can't be had
+			void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+			// only the most recent allocation actually gives its space back, anything else waits for reset()
+			void deallocate(void* ptr, std::size_t bytes);
+
+			// resizes an allocation, keeping its contents
+			// the most recent allocation grows in place if its chunk has room, anything else is copied to a new one
+			void* reallocate(void* ptr, std::size_t oldBytes, std::size_t newBytes, std::size_t alignment = alignof(std::max_align_t));
+
+			// frees every allocation at once, O(1). The chunks are kept to allocate from again
+			void reset();
+
+			// bytes handed out since the last reset
+			std::size_t used() const;
+
+			// bytes of chunks held
+			std::size_t capacity() const;
+
+		private:
+			// chunks start with one of these, and are linked together in the order they're used
+			struct Chunk
+			{
+				Chunk* next;
+				std::size_t size;
+
+				char* begin();
+				char* end();
+			};
+
+			// moves on to a chunk with room for "bytes" aligned to "alignment", reusing the next one if it's big enough
+			void nextChunk(std::size_t bytes, std::size_t alignment);
+
+			std::size_t chunkSize;
+
+			Chunk* first;
+			Chunk* current;
+
+			char* cursor;
+			char* limit;
+
+			// the most recent allocation, the only one that can be resized in place or given back
+			char* latest;
+
+			std::size_t usedBytes;
+			std::size_t capacityBytes;
 	};
-}
\ No newline at end of file
+
+	// an Allocator, typed, for containers' Alloc parameter (ie: DynArray<T, swift::ArenaAllocator<T>>)
+	// copies share the same arena, which has to outlive everything allocated from it
+	template<typename T>
+	class ArenaAllocator
+	{
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			template<typename U>
+			struct rebind
+			{
+				using other = ArenaAllocator<U>;
+			};
+
+			ArenaAllocator(Allocator& arena);
+
+			template<typename U>
+			ArenaAllocator(const ArenaAllocator<U>& other);
+
+			pointer allocate(size_type n);
+			void deallocate(pointer ptr, size_type n);
+
+			// lets a DynArray of relocatable elements grow at the end of the arena without copying them
+			pointer reallocate(pointer ptr, size_type oldCount, size_type newCount);
+
+			Allocator& arena() const;
+
+			template<typename U, typename V>
+			friend bool operator ==(const ArenaAllocator<U>&, const ArenaAllocator<V>&);
+
+			template<typename U, typename V>
+			friend bool operator !=(const ArenaAllocator<U>&, const ArenaAllocator<V>&);
+
+		private:
+			template<typename U>
+			friend class ArenaAllocator;
+
+			static size_type bytesFor(size_type n);
+
+			Allocator* owner;
+	};
+
+	template<typename T>
+	ArenaAllocator<T>::ArenaAllocator(Allocator& arena)
+	:	owner(&arena)
+	{}
+
+	template<typename T>
+	template<typename U>
+	ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other)
+	:	owner(other.owner)
+	{}
+
+	template<typename T>
+	typename ArenaAllocator<T>::pointer ArenaAllocator<T>::allocate(size_type n)
+	{
+		return static_cast<pointer>(owner->allocate(bytesFor(n), alignof(T)));
+	}
+
+	template<typename T>
+	void ArenaAllocator<T>::deallocate(pointer ptr, size_type n)
+	{
+		owner->deallocate(ptr, n * sizeof(T));
+	}
+
+	template<typename T>
+	typename ArenaAllocator<T>::pointer ArenaAllocator<T>::reallocate(pointer ptr, size_type oldCount, size_type newCount)
+	{
+		return static_cast<pointer>(owner->reallocate(ptr, oldCount * sizeof(T), bytesFor(newCount), alignof(T)));
+	}
+
+	template<typename T>
+	Allocator& ArenaAllocator<T>::arena() const
+	{
+		return *owner;
+	}
+
+	template<typename T>
+	typename ArenaAllocator<T>::size_type ArenaAllocator<T>::bytesFor(size_type n)
+	{
+		if(n > std::numeric_limits<size_type>::max() / sizeof(T))
+			throw std::bad_alloc();
+
+		return n * sizeof(T);
+	}
+
+	template<typename U, typename V>
+	bool operator ==(const ArenaAllocator<U>& lhs, const ArenaAllocator<V>& rhs)
+	{
+		return lhs.owner == rhs.owner;
+	}
+
+	template<typename U, typename V>
+	bool operator !=(const ArenaAllocator<U>& lhs, const ArenaAllocator<V>& rhs)
+	{
+		return lhs.owner != rhs.owner;
+	}
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef BIT_OPS_HPP
+#define BIT_OPS_HPP
+
+#include <cstdint>
+
+namespace dbr
+{
+	namespace impl
+	{
+		// how many bits of "n" are set
+		inline unsigned popcount(std::uint64_t n)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned>(__builtin_popcountll(n));
+#else
+			n = n - ((n >> 1) & 0x5555555555555555ull);
+			n = (n & 0x3333333333333333ull) + ((n >> 2) & 0x3333333333333333ull);
+			n = (n + (n >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+			return static_cast<unsigned>((n * 0x0101010101010101ull) >> 56);
+#endif
+		}
+
+		// index of the highest set bit of "n", which must not be 0
+		inline unsigned highestBit(std::uint64_t n)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return 63 - static_cast<unsigned>(__builtin_clzll(n));
+#else
+			unsigned bit = 0;
+			while(n >>= 1)
+				++bit;
+
+			return bit;
+#endif
+		}
+
+		// index of the lowest set bit of "n", which must not be 0
+		inline unsigned lowestBit(std::uint64_t n)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned>(__builtin_ctzll(n));
+#else
+			// the bits below the lowest set one, set
+			return popcount((n & (~n + 1)) - 1);
+#endif
+		}
+	}
+}
+
+#endif
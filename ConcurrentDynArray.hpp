@@ -0,0 +1,332 @@
+#ifndef CONCURRENT_DYN_ARRAY_HPP
+#define CONCURRENT_DYN_ARRAY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "BitOps.hpp"
+
+// an append only array that any number of threads can push_back to at once, without locking
+// elements live in segments that double in size (16, 32, 64, ...), which are never moved or freed once made,
+// so a reference to an element stays good while other threads keep appending
+// claiming a slot is one fetch_add. Each segment is made exactly once, usually ahead of time: by whichever thread
+// claims the middle slot of the segment before it. A thread that needs a segment that's still being made
+// waits for it, so appending is only lock-free as long as segments are made in time
+// segments can be made from any thread, so "Alloc" has to be safe to use from several threads at once
+template<typename T, typename Alloc = std::allocator<T>>
+class ConcurrentDynArray
+{
+	public:
+		using value_type = T;
+		using reference = T&;
+		using const_reference = const T&;
+		using size_type = std::size_t;
+
+		ConcurrentDynArray();
+
+		ConcurrentDynArray(const ConcurrentDynArray&) = delete;
+		ConcurrentDynArray& operator =(const ConcurrentDynArray&) = delete;
+
+		// not thread safe, nothing can be appending at the time
+		~ConcurrentDynArray();
+
+		// safe to call from any number of threads at once
+		// return the index the element was put at
+		template<typename... Args>
+		size_type emplace_back(Args&&...);
+
+		size_type push_back(const_reference);
+		size_type push_back(T&&);
+
+		// only for elements that are ready(), ie: ones this thread appended, or that it was told about
+		// by one that did (through something that synchronizes, like a mutex, or ready() itself)
+		reference operator [](size_type);
+		const_reference operator [](size_type) const;
+
+		// throws std::out_of_range if the element isn't ready yet
+		reference at(size_type);
+		const_reference at(size_type) const;
+
+		// if the element at the index has finished being appended
+		bool ready(size_type) const;
+
+		// how many elements have been claimed by appends, some may not be ready yet
+		size_type size() const;
+		bool empty() const;
+
+		// not thread safe, nothing can be appending at the time
+		void clear();
+
+	private:
+		struct Slot
+		{
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+			std::atomic<bool> ready;
+		};
+
+		using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+		using SlotTraits = std::allocator_traits<SlotAlloc>;
+
+		// size of the first segment, every one after it is twice the one before
+		static constexpr size_type firstBits = 4;
+		static constexpr size_type firstSize = size_type(1) << firstBits;
+
+		// enough segments to hold any index
+		static constexpr size_type segmentCount = sizeof(size_type) * 8 - firstBits;
+
+		// where index "i" lives
+		static size_type segmentOf(size_type i);
+		static size_type offsetOf(size_type i, size_type segment);
+		static size_type segmentSize(size_type segment);
+
+		Slot& slot(size_type i) const;
+
+		// the segment, made if no one has yet, or waited for if someone's making it
+		Slot* segment(size_type segment);
+
+		// makes the segment if no one has started to yet, returning right away otherwise
+		void prepareSegment(size_type segment);
+
+		// only by whoever set its making flag
+		Slot* makeSegment(size_type segment);
+
+		static T* value(Slot& slot);
+
+		std::atomic<size_type> count;
+		std::atomic<Slot*> segments[segmentCount];
+
+		// set by the one thread that gets to make the segment, cleared again if that fails
+		std::atomic<bool> making[segmentCount];
+
+		SlotAlloc allocator;
+};
+
+template<typename T, typename Alloc>
+ConcurrentDynArray<T, Alloc>::ConcurrentDynArray()
+:	count(0)
+{
+	for(auto& seg : segments)
+		seg.store(nullptr, std::memory_order_relaxed);
+
+	for(auto& flag : making)
+		flag.store(false, std::memory_order_relaxed);
+}
+
+template<typename T, typename Alloc>
+ConcurrentDynArray<T, Alloc>::~ConcurrentDynArray()
+{
+	clear();
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::emplace_back(Args&&... args)
+{
+	const size_type i = count.fetch_add(1, std::memory_order_relaxed);
+	const size_type seg = segmentOf(i);
+
+	Slot& s = segment(seg)[offsetOf(i, seg)];
+
+	// if this throws, the slot is just never ready, there's no taking the index back from the other threads
+	new (value(s)) T(std::forward<Args>(args)...);
+	s.ready.store(true, std::memory_order_release);
+
+	// halfway through this one, so the next one is (probably) there by the time anyone needs it
+	if(offsetOf(i, seg) == segmentSize(seg) / 2 && seg + 1 < segmentCount)
+		prepareSegment(seg + 1);
+
+	return i;
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::push_back(const_reference val)
+{
+	return emplace_back(val);
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::push_back(T&& val)
+{
+	return emplace_back(std::move(val));
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::reference ConcurrentDynArray<T, Alloc>::operator [](size_type i)
+{
+	return *value(slot(i));
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::const_reference ConcurrentDynArray<T, Alloc>::operator [](size_type i) const
+{
+	return *value(slot(i));
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::reference ConcurrentDynArray<T, Alloc>::at(size_type i)
+{
+	if(!ready(i))
+		throw std::out_of_range("ConcurrentDynArray::at");
+
+	return (*this)[i];
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::const_reference ConcurrentDynArray<T, Alloc>::at(size_type i) const
+{
+	if(!ready(i))
+		throw std::out_of_range("ConcurrentDynArray::at");
+
+	return (*this)[i];
+}
+
+template<typename T, typename Alloc>
+bool ConcurrentDynArray<T, Alloc>::ready(size_type i) const
+{
+	if(i >= size())
+		return false;
+
+	const size_type seg = segmentOf(i);
+
+	// claimed, but the segment may not have been made yet
+	Slot* slots = segments[seg].load(std::memory_order_acquire);
+
+	return slots && slots[offsetOf(i, seg)].ready.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::size() const
+{
+	return count.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Alloc>
+bool ConcurrentDynArray<T, Alloc>::empty() const
+{
+	return size() == 0;
+}
+
+template<typename T, typename Alloc>
+void ConcurrentDynArray<T, Alloc>::clear()
+{
+	for(size_type seg = 0; seg < segmentCount; ++seg)
+	{
+		Slot* slots = segments[seg].load(std::memory_order_relaxed);
+		if(!slots)
+			continue;
+
+		const size_type n = segmentSize(seg);
+
+		for(size_type j = 0; j < n; ++j)
+		{
+			if(slots[j].ready.load(std::memory_order_relaxed))
+				value(slots[j])->~T();
+
+			SlotTraits::destroy(allocator, &slots[j]);
+		}
+
+		SlotTraits::deallocate(allocator, slots, n);
+		segments[seg].store(nullptr, std::memory_order_relaxed);
+		making[seg].store(false, std::memory_order_relaxed);
+	}
+
+	count.store(0, std::memory_order_relaxed);
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::segmentOf(size_type i)
+{
+	return dbr::impl::highestBit(i + firstSize) - firstBits;
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::offsetOf(size_type i, size_type segment)
+{
+	// segments before this one hold firstSize * (2^segment - 1) elements
+	return i + firstSize - (firstSize << segment);
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::size_type ConcurrentDynArray<T, Alloc>::segmentSize(size_type segment)
+{
+	return firstSize << segment;
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::Slot& ConcurrentDynArray<T, Alloc>::slot(size_type i) const
+{
+	const size_type seg = segmentOf(i);
+	return segments[seg].load(std::memory_order_acquire)[offsetOf(i, seg)];
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::Slot* ConcurrentDynArray<T, Alloc>::segment(size_type seg)
+{
+	for(;;)
+	{
+		Slot* slots = segments[seg].load(std::memory_order_acquire);
+		if(slots)
+			return slots;
+
+		// no one's making it (it wasn't made ahead of time, or making it failed), so it's up to us
+		if(!making[seg].load(std::memory_order_relaxed) && !making[seg].exchange(true, std::memory_order_acquire))
+			return makeSegment(seg);
+
+		std::this_thread::yield();
+	}
+}
+
+template<typename T, typename Alloc>
+void ConcurrentDynArray<T, Alloc>::prepareSegment(size_type seg)
+{
+	if(making[seg].load(std::memory_order_relaxed) || making[seg].exchange(true, std::memory_order_acquire))
+		return;
+
+	// only ahead of time, so if it fails, whoever actually needs it will try again (and get the exception)
+	try
+	{
+		makeSegment(seg);
+	}
+	catch(...)
+	{}
+}
+
+template<typename T, typename Alloc>
+typename ConcurrentDynArray<T, Alloc>::Slot* ConcurrentDynArray<T, Alloc>::makeSegment(size_type seg)
+{
+	const size_type n = segmentSize(seg);
+	Slot* made;
+
+	try
+	{
+		made = SlotTraits::allocate(allocator, n);
+	}
+	catch(...)
+	{
+		making[seg].store(false, std::memory_order_release);
+		throw;
+	}
+
+	for(size_type j = 0; j < n; ++j)
+	{
+		SlotTraits::construct(allocator, &made[j]);
+		made[j].ready.store(false, std::memory_order_relaxed);
+	}
+
+	segments[seg].store(made, std::memory_order_release);
+	return made;
+}
+
+template<typename T, typename Alloc>
+T* ConcurrentDynArray<T, Alloc>::value(Slot& slot)
+{
+	return reinterpret_cast<T*>(&slot.storage);
+}
+
+#endif
@@ -0,0 +1,426 @@
+#ifndef CONCURRENT_QUEUE_HPP
+#define CONCURRENT_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "RingBuffer.hpp"
+
+// bounded lock-free FIFOs over a power of two ring of slots, for handing work between threads
+// none of them block: pushing to a full queue or popping from an empty one fails, and the caller decides whether to
+// spin, yield, or do something else. The batch versions claim several slots at once, so one synchronization
+// is shared by the whole batch
+// the counters each side writes are kept on cache lines of their own, so producers and consumers don't
+// slow each other down by writing next to each other (false sharing)
+// NOTE: the queues are over-aligned, so before C++17 "new" doesn't respect that for them. Prefer making them members
+// or locals, or use an aligned allocation
+namespace dbr
+{
+	namespace impl
+	{
+		constexpr std::size_t cacheLine = 64;
+	}
+}
+
+// one thread pushes, one (other) thread pops
+// each side keeps a copy of the other side's counter, and only reloads it when its copy says the queue is full/empty
+template<typename T, typename Alloc = std::allocator<T>>
+class SpscQueue
+{
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+
+		// rounded up to a power of two
+		explicit SpscQueue(size_type capacity);
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator =(const SpscQueue&) = delete;
+
+		~SpscQueue();
+
+		// producer only. These return false if it's full
+		template<typename... Args>
+		bool tryEmplace(Args&&...);
+
+		bool tryPush(const T&);
+		bool tryPush(T&&);
+
+		// producer only. Moves as many of "values" in as there's room for, and returns how many that was
+		size_type pushBatch(T* values, size_type n);
+
+		// consumer only. Returns false if it's empty
+		bool tryPop(T& out);
+
+		// consumer only. Moves up to "n" elements out to "out", and returns how many that was
+		size_type popBatch(T* out, size_type n);
+
+		size_type capacity() const;
+
+	private:
+		dbr::impl::RingSlots<T, Alloc> slots;
+
+		// written by the producer
+		alignas(dbr::impl::cacheLine) std::atomic<size_type> tail;
+		size_type cachedHead;
+
+		// written by the consumer
+		alignas(dbr::impl::cacheLine) std::atomic<size_type> head;
+		size_type cachedTail;
+};
+
+// any number of threads push, any number pop
+// every slot has a sequence number that says whose turn it is to use it: a producer of the current lap,
+// or a consumer. Claiming a slot is one compare-exchange on the shared counter, after which the slot is used
+// without any more contention (Vyukov's bounded queue)
+// T has to be nothrow move constructible: an element is made before its slot is claimed, and moved in after
+template<typename T, typename Alloc = std::allocator<T>>
+class MpmcQueue
+{
+	static_assert(std::is_nothrow_move_constructible<T>::value, "MpmcQueue elements have to be nothrow move constructible");
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+
+		// rounded up to a power of two, and at least 2
+		explicit MpmcQueue(size_type capacity);
+
+		MpmcQueue(const MpmcQueue&) = delete;
+		MpmcQueue& operator =(const MpmcQueue&) = delete;
+
+		~MpmcQueue();
+
+		// these return false if it's full
+		template<typename... Args>
+		bool tryEmplace(Args&&...);
+
+		bool tryPush(const T&);
+		bool tryPush(T&&);
+
+		// moves as many of "values" in as there's room for, and returns how many that was
+		// the batch's slots are claimed all at once, so its elements stay together in the queue
+		size_type pushBatch(T* values, size_type n);
+
+		// returns false if it's empty
+		bool tryPop(T& out);
+
+		// moves up to "n" elements out to "out", and returns how many that was
+		size_type popBatch(T* out, size_type n);
+
+		size_type capacity() const;
+
+	private:
+		struct Cell
+		{
+			// pos: free for the producer of pos, pos + 1: full for the consumer of pos
+			std::atomic<size_type> sequence;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+			T* value();
+		};
+
+		// claims up to "n" slots from "counter", starting where the sequence numbers are "pos + ready"
+		// returns the first slot's position and how many were claimed (0 if none were ready)
+		std::pair<size_type, size_type> claim(std::atomic<size_type>& counter, size_type ready, size_type n);
+
+		// lets the producer of the next lap have the slot
+		void release(Cell&, size_type pos);
+
+		dbr::impl::RingSlots<Cell, Alloc> cells;
+
+		alignas(dbr::impl::cacheLine) std::atomic<size_type> enqueuePos;
+		alignas(dbr::impl::cacheLine) std::atomic<size_type> dequeuePos;
+};
+
+// SpscQueue
+template<typename T, typename Alloc>
+SpscQueue<T, Alloc>::SpscQueue(size_type capacity)
+:	slots(capacity),
+	tail(0),
+	cachedHead(0),
+	head(0),
+	cachedTail(0)
+{}
+
+template<typename T, typename Alloc>
+SpscQueue<T, Alloc>::~SpscQueue()
+{
+	const size_type last = tail.load();
+
+	for(size_type pos = head.load(); pos != last; ++pos)
+		slots[pos]->~T();
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+bool SpscQueue<T, Alloc>::tryEmplace(Args&&... args)
+{
+	const size_type pos = tail.load(std::memory_order_relaxed);
+
+	if(pos - cachedHead == slots.capacity())
+	{
+		cachedHead = head.load(std::memory_order_acquire);
+
+		if(pos - cachedHead == slots.capacity())
+			return false;
+	}
+
+	new (slots[pos]) T(std::forward<Args>(args)...);
+	tail.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+template<typename T, typename Alloc>
+bool SpscQueue<T, Alloc>::tryPush(const T& value)
+{
+	return tryEmplace(value);
+}
+
+template<typename T, typename Alloc>
+bool SpscQueue<T, Alloc>::tryPush(T&& value)
+{
+	return tryEmplace(std::move(value));
+}
+
+template<typename T, typename Alloc>
+typename SpscQueue<T, Alloc>::size_type SpscQueue<T, Alloc>::pushBatch(T* values, size_type n)
+{
+	const size_type pos = tail.load(std::memory_order_relaxed);
+
+	if(slots.capacity() - (pos - cachedHead) < n)
+		cachedHead = head.load(std::memory_order_acquire);
+
+	const size_type count = std::min(n, slots.capacity() - (pos - cachedHead));
+
+	size_type i = 0;
+
+	// publish whatever made it in, even if one throws
+	try
+	{
+		for(; i < count; ++i)
+			new (slots[pos + i]) T(std::move(values[i]));
+	}
+	catch(...)
+	{
+		tail.store(pos + i, std::memory_order_release);
+		throw;
+	}
+
+	tail.store(pos + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T, typename Alloc>
+bool SpscQueue<T, Alloc>::tryPop(T& out)
+{
+	return popBatch(&out, 1) == 1;
+}
+
+template<typename T, typename Alloc>
+typename SpscQueue<T, Alloc>::size_type SpscQueue<T, Alloc>::popBatch(T* out, size_type n)
+{
+	const size_type pos = head.load(std::memory_order_relaxed);
+
+	if(cachedTail - pos < n)
+		cachedTail = tail.load(std::memory_order_acquire);
+
+	const size_type count = std::min(n, cachedTail - pos);
+
+	size_type i = 0;
+
+	// if a move throws, the element it was moving from is dropped, and the ones before it stay popped
+	try
+	{
+		for(; i < count; ++i)
+		{
+			T* value = slots[pos + i];
+			out[i] = std::move(*value);
+			value->~T();
+		}
+	}
+	catch(...)
+	{
+		slots[pos + i]->~T();
+		head.store(pos + i + 1, std::memory_order_release);
+		throw;
+	}
+
+	head.store(pos + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T, typename Alloc>
+typename SpscQueue<T, Alloc>::size_type SpscQueue<T, Alloc>::capacity() const
+{
+	return slots.capacity();
+}
+
+// MpmcQueue
+template<typename T, typename Alloc>
+T* MpmcQueue<T, Alloc>::Cell::value()
+{
+	return reinterpret_cast<T*>(&storage);
+}
+
+template<typename T, typename Alloc>
+MpmcQueue<T, Alloc>::MpmcQueue(size_type capacity)
+:	cells(std::max<size_type>(capacity, 2)),
+	enqueuePos(0),
+	dequeuePos(0)
+{
+	// with only 1 slot, "full for the consumer of pos" and "free for the producer of pos + 1" would be the same number
+	for(size_type i = 0; i < cells.capacity(); ++i)
+	{
+		Cell* cell = new (cells[i]) Cell;
+		cell->sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template<typename T, typename Alloc>
+MpmcQueue<T, Alloc>::~MpmcQueue()
+{
+	const size_type last = enqueuePos.load();
+
+	for(size_type pos = dequeuePos.load(); pos != last; ++pos)
+		cells[pos]->value()->~T();
+
+	for(size_type i = 0; i < cells.capacity(); ++i)
+		cells[i]->~Cell();
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+bool MpmcQueue<T, Alloc>::tryEmplace(Args&&... args)
+{
+	// made before claiming a slot, so nothing can throw while one is held
+	T value(std::forward<Args>(args)...);
+	return pushBatch(&value, 1) == 1;
+}
+
+template<typename T, typename Alloc>
+bool MpmcQueue<T, Alloc>::tryPush(const T& value)
+{
+	return tryEmplace(value);
+}
+
+template<typename T, typename Alloc>
+bool MpmcQueue<T, Alloc>::tryPush(T&& value)
+{
+	return tryEmplace(std::move(value));
+}
+
+template<typename T, typename Alloc>
+typename MpmcQueue<T, Alloc>::size_type MpmcQueue<T, Alloc>::pushBatch(T* values, size_type n)
+{
+	const std::pair<size_type, size_type> claimed = claim(enqueuePos, 0, n);
+
+	for(size_type i = 0; i < claimed.second; ++i)
+	{
+		const size_type pos = claimed.first + i;
+		Cell& cell = *cells[pos];
+
+		new (cell.value()) T(std::move(values[i]));
+		cell.sequence.store(pos + 1, std::memory_order_release);
+	}
+
+	return claimed.second;
+}
+
+template<typename T, typename Alloc>
+bool MpmcQueue<T, Alloc>::tryPop(T& out)
+{
+	return popBatch(&out, 1) == 1;
+}
+
+template<typename T, typename Alloc>
+typename MpmcQueue<T, Alloc>::size_type MpmcQueue<T, Alloc>::popBatch(T* out, size_type n)
+{
+	const std::pair<size_type, size_type> claimed = claim(dequeuePos, 1, n);
+
+	size_type i = 0;
+
+	// every claimed slot has to be released, or producers would wait on it forever
+	// so if a move throws, the rest of the batch is dropped
+	try
+	{
+		for(; i < claimed.second; ++i)
+		{
+			const size_type pos = claimed.first + i;
+			Cell& cell = *cells[pos];
+
+			out[i] = std::move(*cell.value());
+			release(cell, pos);
+		}
+	}
+	catch(...)
+	{
+		for(; i < claimed.second; ++i)
+			release(*cells[claimed.first + i], claimed.first + i);
+
+		throw;
+	}
+
+	return claimed.second;
+}
+
+template<typename T, typename Alloc>
+typename MpmcQueue<T, Alloc>::size_type MpmcQueue<T, Alloc>::capacity() const
+{
+	return cells.capacity();
+}
+
+template<typename T, typename Alloc>
+std::pair<typename MpmcQueue<T, Alloc>::size_type, typename MpmcQueue<T, Alloc>::size_type>
+MpmcQueue<T, Alloc>::claim(std::atomic<size_type>& counter, size_type ready, size_type n)
+{
+	n = std::min(n, cells.capacity());
+
+	size_type pos = counter.load(std::memory_order_relaxed);
+
+	while(n > 0)
+	{
+		const size_type sequence = cells[pos]->sequence.load(std::memory_order_acquire);
+		const std::intptr_t diff = static_cast<std::intptr_t>(sequence - (pos + ready));
+
+		if(diff < 0)
+		{
+			// the slot is still in use from the last lap: full for producers, empty for consumers
+			return {pos, 0};
+		}
+
+		if(diff > 0)
+		{
+			// someone else claimed it already
+			pos = counter.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// the slots after it may be ready too. Once one is, it stays that way until it's claimed,
+		// which can't happen without moving "counter" past "pos" first
+		size_type count = 1;
+		while(count < n && cells[pos + count]->sequence.load(std::memory_order_acquire) == pos + count + ready)
+			++count;
+
+		if(counter.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+			return {pos, count};
+	}
+
+	return {pos, 0};
+}
+
+template<typename T, typename Alloc>
+void MpmcQueue<T, Alloc>::release(Cell& cell, size_type pos)
+{
+	cell.value()->~T();
+	cell.sequence.store(pos + cells.capacity(), std::memory_order_release);
+}
+
+#endif
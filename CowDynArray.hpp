@@ -0,0 +1,448 @@
+#ifndef COW_DYN_ARRAY_HPP
+#define COW_DYN_ARRAY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "DynArray.hpp"
+
+// a copy-on-write array for data many threads read while one occasionally updates it (RCU style)
+// readers take a snapshot: an immutable version of the whole array, without locking or copying anything
+// writers build the next version and publish it atomically. The elements are split into chunks of ChunkSize,
+// and a new version shares every chunk it didn't change with the one before it, so an update costs
+// the chunks it touched, not the whole array
+// each old version is reclaimed once no snapshot of it is left, however many snapshots of other versions there are.
+// That happens on the writer's side: on the next update, or when reclaim() is called
+// a reclaimed version gives back its chunks, and is reused for a later one rather than deleted, since a reader
+// that lost a race with the writer may still briefly count itself in and back out of it
+template<typename T, std::size_t ChunkSize = 256>
+class CowDynArray
+{
+	static_assert(ChunkSize > 0, "CowDynArray chunks need room for at least one element");
+
+	private:
+		using Chunk = DynArray<T>;
+		using ChunkPtr = std::shared_ptr<Chunk>;
+
+		struct Version
+		{
+			DynArray<ChunkPtr> chunks;
+			std::size_t size = 0;
+
+			// snapshots of this version still out there, plus one while it's the current version
+			// (plus readers that are about to find out it isn't current anymore)
+			std::atomic<std::size_t> refs{0};
+		};
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+
+		// an immutable view of the array as it was when the snapshot was taken
+		// cheap to copy, and keeps its version alive while it exists
+		class Snapshot
+		{
+			public:
+				Snapshot(const Snapshot&);
+				Snapshot& operator =(const Snapshot&);
+				~Snapshot();
+
+				const T& operator [](size_type) const;
+				const T& at(size_type) const;
+
+				size_type size() const;
+				bool empty() const;
+
+				// calls "fn" on every element in order, a chunk at a time
+				template<typename Fn>
+				void forEach(Fn fn) const;
+
+			private:
+				friend class CowDynArray;
+
+				explicit Snapshot(Version*);
+
+				Version* version;
+		};
+
+		// a writer's draft of the next version
+		// it starts out sharing every chunk with the current version, and copies a chunk the first time it's changed
+		class Builder
+		{
+			public:
+				const T& operator [](size_type) const;
+
+				// for changing an element (copies its chunk, if that hasn't happened yet)
+				T& edit(size_type);
+				void set(size_type, const T&);
+
+				void push_back(const T&);
+				void push_back(T&&);
+				void pop_back();
+				void clear();
+
+				size_type size() const;
+				bool empty() const;
+
+			private:
+				friend class CowDynArray;
+
+				explicit Builder(const Version&);
+
+				// the chunk, copied first if it's still shared with the current version
+				Chunk& own(size_type chunk);
+
+				DynArray<ChunkPtr> chunks;
+
+				// chunks this draft has made or copied, and so can change
+				DynArray<bool> owned;
+
+				size_type count;
+		};
+
+		CowDynArray();
+
+		CowDynArray(const CowDynArray&) = delete;
+		CowDynArray& operator =(const CowDynArray&) = delete;
+
+		// every snapshot has to be gone by now
+		~CowDynArray();
+
+		// safe from any thread, at any time
+		Snapshot snapshot() const;
+
+		// calls "fn" with a Builder of the next version, then publishes it
+		// writers take turns, readers aren't affected. If "fn" throws, nothing is published
+		template<typename Fn>
+		void update(Fn fn);
+
+		// frees old versions no snapshot has anymore
+		void reclaim();
+
+	private:
+		// reclaim(), for when the writer lock is already held
+		void reclaimRetired();
+
+		std::atomic<Version*> current;
+
+		// versions that have been replaced, but may still have snapshots out
+		DynArray<Version*> retired;
+
+		// reclaimed versions, to be reused
+		// both lists always have room for every version, so moving versions between them can't fail
+		DynArray<Version*> spare;
+		size_type versions;
+
+		std::mutex writer;
+};
+
+// Snapshot
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::Snapshot::Snapshot(Version* version)
+:	version(version)
+{}
+
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::Snapshot::Snapshot(const Snapshot& other)
+:	version(other.version)
+{
+	++version->refs;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename CowDynArray<T, ChunkSize>::Snapshot& CowDynArray<T, ChunkSize>::Snapshot::operator =(const Snapshot& other)
+{
+	++other.version->refs;
+	--version->refs;
+
+	version = other.version;
+	return *this;
+}
+
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::Snapshot::~Snapshot()
+{
+	--version->refs;
+}
+
+template<typename T, std::size_t ChunkSize>
+const T& CowDynArray<T, ChunkSize>::Snapshot::operator [](size_type i) const
+{
+	return (*version->chunks[i / ChunkSize])[i % ChunkSize];
+}
+
+template<typename T, std::size_t ChunkSize>
+const T& CowDynArray<T, ChunkSize>::Snapshot::at(size_type i) const
+{
+	if(i >= version->size)
+		throw std::out_of_range("CowDynArray::Snapshot::at");
+
+	return (*this)[i];
+}
+
+template<typename T, std::size_t ChunkSize>
+typename CowDynArray<T, ChunkSize>::size_type CowDynArray<T, ChunkSize>::Snapshot::size() const
+{
+	return version->size;
+}
+
+template<typename T, std::size_t ChunkSize>
+bool CowDynArray<T, ChunkSize>::Snapshot::empty() const
+{
+	return version->size == 0;
+}
+
+template<typename T, std::size_t ChunkSize>
+template<typename Fn>
+void CowDynArray<T, ChunkSize>::Snapshot::forEach(Fn fn) const
+{
+	for(size_type c = 0; c < version->chunks.size(); ++c)
+	{
+		const Chunk& chunk = *version->chunks[c];
+
+		for(size_type i = 0; i < chunk.size(); ++i)
+			fn(chunk[i]);
+	}
+}
+
+// Builder
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::Builder::Builder(const Version& base)
+:	chunks(base.chunks),
+	count(base.size)
+{
+	owned.resize(chunks.size());
+}
+
+template<typename T, std::size_t ChunkSize>
+const T& CowDynArray<T, ChunkSize>::Builder::operator [](size_type i) const
+{
+	return (*chunks[i / ChunkSize])[i % ChunkSize];
+}
+
+template<typename T, std::size_t ChunkSize>
+T& CowDynArray<T, ChunkSize>::Builder::edit(size_type i)
+{
+	return own(i / ChunkSize)[i % ChunkSize];
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::Builder::set(size_type i, const T& value)
+{
+	edit(i) = value;
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::Builder::push_back(const T& value)
+{
+	push_back(T(value));
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::Builder::push_back(T&& value)
+{
+	const bool newChunk = count % ChunkSize == 0;
+
+	if(newChunk)
+	{
+		chunks.push_back(std::make_shared<Chunk>(ChunkSize));
+
+		try
+		{
+			owned.push_back(true);
+		}
+		catch(...)
+		{
+			chunks.pop_back();
+			throw;
+		}
+	}
+
+	try
+	{
+		own(count / ChunkSize).push_back(std::move(value));
+	}
+	catch(...)
+	{
+		// don't leave an empty chunk behind
+		if(newChunk)
+		{
+			chunks.pop_back();
+			owned.pop_back();
+		}
+
+		throw;
+	}
+
+	++count;
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::Builder::pop_back()
+{
+	--count;
+
+	if(count % ChunkSize == 0)
+	{
+		chunks.pop_back();
+		owned.pop_back();
+	}
+	else
+	{
+		own(count / ChunkSize).pop_back();
+	}
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::Builder::clear()
+{
+	chunks.clear();
+	owned.clear();
+	count = 0;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename CowDynArray<T, ChunkSize>::size_type CowDynArray<T, ChunkSize>::Builder::size() const
+{
+	return count;
+}
+
+template<typename T, std::size_t ChunkSize>
+bool CowDynArray<T, ChunkSize>::Builder::empty() const
+{
+	return count == 0;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename CowDynArray<T, ChunkSize>::Chunk& CowDynArray<T, ChunkSize>::Builder::own(size_type chunk)
+{
+	if(!owned[chunk])
+	{
+		const Chunk& shared = *chunks[chunk];
+
+		ChunkPtr copy = std::make_shared<Chunk>(ChunkSize);
+		for(size_type i = 0; i < shared.size(); ++i)
+			copy->push_back(shared[i]);
+
+		chunks[chunk] = std::move(copy);
+		owned[chunk] = true;
+	}
+
+	return *chunks[chunk];
+}
+
+// CowDynArray
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::CowDynArray()
+:	current(new Version),
+	versions(1)
+{
+	++current.load()->refs;
+}
+
+template<typename T, std::size_t ChunkSize>
+CowDynArray<T, ChunkSize>::~CowDynArray()
+{
+	for(std::size_t i = 0; i < retired.size(); ++i)
+		delete retired[i];
+
+	for(std::size_t i = 0; i < spare.size(); ++i)
+		delete spare[i];
+
+	delete current.load();
+}
+
+template<typename T, std::size_t ChunkSize>
+typename CowDynArray<T, ChunkSize>::Snapshot CowDynArray<T, ChunkSize>::snapshot() const
+{
+	for(;;)
+	{
+		Version* version = current.load();
+		++version->refs;
+
+		// it may have been replaced (and even reclaimed) between loading it and counting ourselves in
+		// versions aren't deleted while the array's around, so counting in was harmless, but it's not ours to use
+		if(current.load() == version)
+			return Snapshot(version);
+
+		--version->refs;
+	}
+}
+
+template<typename T, std::size_t ChunkSize>
+template<typename Fn>
+void CowDynArray<T, ChunkSize>::update(Fn fn)
+{
+	std::lock_guard<std::mutex> lock(writer);
+
+	Version* old = current.load();
+
+	Builder builder(*old);
+	fn(builder);
+
+	// make room for another version before making it, so nothing can fail after publishing it
+	Version* next;
+
+	if(spare.empty())
+	{
+		retired.reserve(versions + 1);
+		spare.reserve(versions + 1);
+
+		next = new Version;
+		++versions;
+	}
+	else
+	{
+		next = spare[spare.size() - 1];
+		spare.pop_back();
+	}
+
+	next->chunks = std::move(builder.chunks);
+	next->size = builder.count;
+
+	// added to, since readers that lost a race with an earlier update may still be counting in and out of it
+	++next->refs;
+	current.store(next);
+
+	// the old version's current reference goes with it
+	--old->refs;
+	retired.push_back(old);
+
+	reclaimRetired();
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::reclaim()
+{
+	std::lock_guard<std::mutex> lock(writer);
+	reclaimRetired();
+}
+
+template<typename T, std::size_t ChunkSize>
+void CowDynArray<T, ChunkSize>::reclaimRetired()
+{
+	for(std::size_t i = 0; i < retired.size();)
+	{
+		Version* version = retired[i];
+
+		if(version->refs.load() == 0)
+		{
+			version->chunks.clear();
+			version->size = 0;
+			spare.push_back(version);
+
+			retired[i] = retired[retired.size() - 1];
+			retired.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef DELTA_DYN_ARRAY_HPP
+#define DELTA_DYN_ARRAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "DynArray.hpp"
+
+namespace dbr
+{
+	namespace impl
+	{
+		// maps small negative and positive differences both to small unsigned numbers: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+		inline std::uint64_t zigzag(std::uint64_t delta)
+		{
+			return (delta << 1) ^ (0 - (delta >> 63));
+		}
+
+		inline std::uint64_t unzigzag(std::uint64_t bits)
+		{
+			return (bits >> 1) ^ (0 - (bits & 1));
+		}
+
+		// LEB128: 7 bits per byte, low bits first, the high bit set on every byte but the last
+		inline void writeVarint(DynArray<std::uint8_t>& out, std::uint64_t value)
+		{
+			while(value >= 0x80)
+			{
+				out.push_back(static_cast<std::uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+
+			out.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		inline std::uint64_t readVarint(const std::uint8_t*& in)
+		{
+			// most deltas are small, so the one byte case is checked first
+			std::uint64_t value = *in++;
+			if(value < 0x80)
+				return value;
+
+			value &= 0x7f;
+
+			for(unsigned shift = 7;; shift += 7)
+			{
+				const std::uint64_t byte = *in++;
+				value |= (byte & 0x7f) << shift;
+
+				if(byte < 0x80)
+					return value;
+			}
+		}
+	}
+}
+
+// a read-only array of integers, stored as the differences between neighbours, each as a varint
+// for sorted or slowly changing data (IDs, timestamps, offsets), most differences fit in a byte or two
+// the elements are split into blocks of BlockSize. Each block keeps its first value and where its bytes start,
+// so getting to an element only decodes from the start of its block, and decoding a range is one sequential pass
+template<typename T, std::size_t BlockSize = 128>
+class DeltaDynArray
+{
+	static_assert(std::is_integral<T>::value, "DeltaDynArray only holds integers");
+	static_assert(BlockSize > 0, "DeltaDynArray blocks need room for at least one element");
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+
+		DeltaDynArray();
+
+		template<typename iter>
+		DeltaDynArray(iter first, iter last);
+
+		// decodes from the start of the element's block
+		value_type operator [](size_type) const;
+
+		// throws std::out_of_range
+		value_type at(size_type) const;
+
+		// writes elements ["first", "first" + "n") to "out"
+		void decode(size_type first, size_type n, value_type* out) const;
+
+		// calls "fn" on every element in order
+		template<typename Fn>
+		void forEach(Fn fn) const;
+
+		size_type size() const;
+		bool empty() const;
+
+		// how much memory the compressed elements take up, index included
+		size_type byteSize() const;
+
+	private:
+		struct Block
+		{
+			// the block's first element
+			std::uint64_t first;
+
+			// where the differences for the rest of the block start in "bytes"
+			size_type offset;
+		};
+
+		static std::uint64_t toBits(value_type);
+
+		DynArray<Block> blocks;
+		DynArray<std::uint8_t> bytes;
+
+		size_type count;
+};
+
+template<typename T, std::size_t BlockSize>
+DeltaDynArray<T, BlockSize>::DeltaDynArray()
+:	count(0)
+{}
+
+template<typename T, std::size_t BlockSize>
+template<typename iter>
+DeltaDynArray<T, BlockSize>::DeltaDynArray(iter first, iter last)
+:	count(0)
+{
+	std::uint64_t previous = 0;
+
+	for(; first != last; ++first, ++count)
+	{
+		const std::uint64_t value = toBits(*first);
+
+		if(count % BlockSize == 0)
+			blocks.push_back({value, bytes.size()});
+		else
+			dbr::impl::writeVarint(bytes, dbr::impl::zigzag(value - previous));
+
+		previous = value;
+	}
+}
+
+template<typename T, std::size_t BlockSize>
+typename DeltaDynArray<T, BlockSize>::value_type DeltaDynArray<T, BlockSize>::operator [](size_type i) const
+{
+	value_type value;
+	decode(i, 1, &value);
+	return value;
+}
+
+template<typename T, std::size_t BlockSize>
+typename DeltaDynArray<T, BlockSize>::value_type DeltaDynArray<T, BlockSize>::at(size_type i) const
+{
+	if(i >= count)
+		throw std::out_of_range("DeltaDynArray::at");
+
+	return (*this)[i];
+}
+
+template<typename T, std::size_t BlockSize>
+void DeltaDynArray<T, BlockSize>::decode(size_type first, size_type n, value_type* out) const
+{
+	if(n == 0)
+		return;
+
+	size_type block = first / BlockSize;
+	size_type inBlock = first % BlockSize;
+
+	const std::uint8_t* in = bytes.data() + blocks[block].offset;
+	std::uint64_t value = blocks[block].first;
+
+	// catch up to "first"
+	for(size_type i = 0; i < inBlock; ++i)
+		value += dbr::impl::unzigzag(dbr::impl::readVarint(in));
+
+	for(size_type i = 0;;)
+	{
+		out[i] = static_cast<value_type>(value);
+
+		if(++i == n)
+			break;
+
+		if(++inBlock == BlockSize)
+		{
+			++block;
+			inBlock = 0;
+
+			// blocks' bytes are back to back, so "in" is already at the next block's start
+			value = blocks[block].first;
+		}
+		else
+		{
+			value += dbr::impl::unzigzag(dbr::impl::readVarint(in));
+		}
+	}
+}
+
+template<typename T, std::size_t BlockSize>
+template<typename Fn>
+void DeltaDynArray<T, BlockSize>::forEach(Fn fn) const
+{
+	const std::uint8_t* in = bytes.data();
+	std::uint64_t value = 0;
+
+	for(size_type i = 0; i < count; ++i)
+	{
+		if(i % BlockSize == 0)
+			value = blocks[i / BlockSize].first;
+		else
+			value += dbr::impl::unzigzag(dbr::impl::readVarint(in));
+
+		fn(static_cast<value_type>(value));
+	}
+}
+
+template<typename T, std::size_t BlockSize>
+typename DeltaDynArray<T, BlockSize>::size_type DeltaDynArray<T, BlockSize>::size() const
+{
+	return count;
+}
+
+template<typename T, std::size_t BlockSize>
+bool DeltaDynArray<T, BlockSize>::empty() const
+{
+	return count == 0;
+}
+
+template<typename T, std::size_t BlockSize>
+typename DeltaDynArray<T, BlockSize>::size_type DeltaDynArray<T, BlockSize>::byteSize() const
+{
+	return bytes.size() + blocks.size() * sizeof(Block);
+}
+
+template<typename T, std::size_t BlockSize>
+std::uint64_t DeltaDynArray<T, BlockSize>::toBits(value_type value)
+{
+	// differences are taken modulo 2^64, so signed values just wrap around like unsigned ones
+	return static_cast<std::uint64_t>(value);
+}
+
+#endif
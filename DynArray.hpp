@@ -1,24 +1,291 @@
+#ifndef DYN_ARRAY_HPP
+#define DYN_ARRAY_HPP
+
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace dbr
+{
+	// whether a T can be moved to a new address with a plain memcpy of its bytes (and the old bytes then forgotten)
+	// true for anything trivially copyable, specialize it for types that are safe to relocate even though they
+	// aren't trivially copyable (ie: most std::unique_ptr-like handles)
+	template<typename T>
+	struct is_trivially_relocatable : std::is_trivially_copyable<T>
+	{};
+
+	// whether an allocator has room inside of itself for any block that one comparing unequal to it hands out
+	// (ie: InlineAllocator), so moving a DynArray from one to the other never allocates, it only moves the elements
+	// false unless specialized
+	template<typename Alloc>
+	struct has_inline_storage : std::false_type
+	{};
+
+	// what moving elements around has cost a DynArray so far
+	// (the same type for every DynArray, so they can be summed up across arrays)
+	struct ReallocStats
+	{
+		// times the elements were moved to a new block
+		std::size_t reallocations;
+
+		// times the elements were moved within their block (to use headroom at the other end, or for an insert)
+		std::size_t slides;
+
+		// bytes of elements moved by either of the above
+		// doesn't include anything an allocator with reallocate() moved itself
+		std::size_t bytesCopied;
+
+		// most elements the array has had room for at once
+		std::size_t peakCapacity;
+	};
+
+	// what happened when a DynArray moved its elements
+	struct MoveEvent
+	{
+		// moved to a new block, rather than within the same one
+		bool newBlock;
+
+		// bytes of elements DynArray moved itself
+		std::size_t bytesCopied;
+
+		// how many elements the block has room for
+		std::size_t capacity;
+	};
+
+	// observers for DynArray, told every time the elements move to new addresses
+	// an observer is called as: observer(const T* newBegin, std::size_t size, const MoveEvent&)
+	// it's a base of the DynArray, so an empty one takes no space, and the call is inlined
+	namespace observe
+	{
+		// the default, compiles away entirely
+		struct None
+		{
+			template<typename T>
+			void operator ()(const T*, std::size_t, const MoveEvent&);
+		};
+
+		// keeps a ReallocStats
+		struct Stats
+		{
+			template<typename T>
+			void operator ()(const T*, std::size_t, const MoveEvent&);
+
+			const ReallocStats& stats() const;
+
+			private:
+				ReallocStats current = {};
+		};
+
+		// forwards to a std::function set at runtime
+		template<typename T>
+		struct Callback
+		{
+			void operator ()(const T* begin, std::size_t size, const MoveEvent&);
+
+			void setCallback(const std::function<void(const T*, std::size_t)>&);
+
+			private:
+				std::function<void(const T*, std::size_t)> callback;
+		};
+
+		template<typename T>
+		void None::operator ()(const T*, std::size_t, const MoveEvent&)
+		{}
+
+		template<typename T>
+		void Stats::operator ()(const T*, std::size_t, const MoveEvent& event)
+		{
+			if(event.newBlock)
+				++current.reallocations;
+			else
+				++current.slides;
+
+			current.bytesCopied += event.bytesCopied;
+
+			if(event.capacity > current.peakCapacity)
+				current.peakCapacity = event.capacity;
+		}
+
+		inline const ReallocStats& Stats::stats() const
+		{
+			return current;
+		}
+
+		template<typename T>
+		void Callback<T>::operator ()(const T* begin, std::size_t size, const MoveEvent&)
+		{
+			if(callback)
+				callback(begin, size);
+		}
+
+		template<typename T>
+		void Callback<T>::setCallback(const std::function<void(const T*, std::size_t)>& cb)
+		{
+			callback = cb;
+		}
+	}
+
+	// growth policies for DynArray
+	// a policy provides:
+	//	static std::size_t initial(std::size_t elementSize);	capacity of the first block
+	//	static std::size_t grow(std::size_t capacity, std::size_t elementSize);	capacity to grow a full block to
+	namespace growth
+	{
+		// capacity * Num / Den
+		template<std::size_t Num, std::size_t Den>
+		struct Factor
+		{
+			static std::size_t initial(std::size_t elementSize);
+			static std::size_t grow(std::size_t capacity, std::size_t elementSize);
+		};
+
+		using Double = Factor<2, 1>;
+
+		// wastes less memory on big arrays, and lets freed blocks be reused for later growth
+		using OneAndAHalf = Factor<3, 2>;
+
+		// grows by Base, then rounds the block up to a whole number of pages
+		// so the allocator (or mmap) doesn't waste the tail of the last page
+		template<typename Base = Double, std::size_t PageSize = 4096>
+		struct PageRounded
+		{
+			static std::size_t initial(std::size_t elementSize);
+			static std::size_t grow(std::size_t capacity, std::size_t elementSize);
+		};
+
+		// grows by Base, but never by more than MaxStep bytes at a time
+		// for huge arrays, where doubling would reserve gigabytes that may never be used
+		template<std::size_t MaxStep, typename Base = Double>
+		struct Capped
+		{
+			static std::size_t initial(std::size_t elementSize);
+			static std::size_t grow(std::size_t capacity, std::size_t elementSize);
+		};
+
+		// starts with room for Initial elements, then grows by Base
+		// ie: for an allocator with room for exactly Initial elements inside of itself (see SmallDynArray)
+		template<std::size_t Initial, typename Base = Double>
+		struct StartingAt
+		{
+			static std::size_t initial(std::size_t elementSize);
+			static std::size_t grow(std::size_t capacity, std::size_t elementSize);
+		};
+
+		template<std::size_t Num, std::size_t Den>
+		std::size_t Factor<Num, Den>::initial(std::size_t)
+		{
+			return 8;
+		}
+
+		template<std::size_t Num, std::size_t Den>
+		std::size_t Factor<Num, Den>::grow(std::size_t capacity, std::size_t)
+		{
+			return capacity * Num / Den;
+		}
+
+		template<typename Base, std::size_t PageSize>
+		std::size_t PageRounded<Base, PageSize>::initial(std::size_t elementSize)
+		{
+			return Base::initial(elementSize);
+		}
+
+		template<typename Base, std::size_t PageSize>
+		std::size_t PageRounded<Base, PageSize>::grow(std::size_t capacity, std::size_t elementSize)
+		{
+			const std::size_t bytes = Base::grow(capacity, elementSize) * elementSize;
+			const std::size_t rounded = (bytes + PageSize - 1) / PageSize * PageSize;
+
+			return rounded / elementSize;
+		}
+
+		template<std::size_t MaxStep, typename Base>
+		std::size_t Capped<MaxStep, Base>::initial(std::size_t elementSize)
+		{
+			return Base::initial(elementSize);
+		}
+
+		template<std::size_t MaxStep, typename Base>
+		std::size_t Capped<MaxStep, Base>::grow(std::size_t capacity, std::size_t elementSize)
+		{
+			const std::size_t grown = Base::grow(capacity, elementSize);
+			const std::size_t maxStep = MaxStep / elementSize ? MaxStep / elementSize : 1;
+
+			return grown - capacity > maxStep ? capacity + maxStep : grown;
+		}
+
+		template<std::size_t Initial, typename Base>
+		std::size_t StartingAt<Initial, Base>::initial(std::size_t)
+		{
+			return Initial;
+		}
+
+		template<std::size_t Initial, typename Base>
+		std::size_t StartingAt<Initial, Base>::grow(std::size_t capacity, std::size_t elementSize)
+		{
+			return Base::grow(capacity, elementSize);
+		}
+	}
+
+	namespace impl
+	{
+		template<typename...>
+		struct voider
+		{
+			using type = void;
+		};
+
+		// detects a C++23 style allocator that can tell us how big a block it actually gave us:
+		// Alloc::allocate_at_least(size_type) -> { pointer ptr; size_type count; }
+		template<typename Alloc, typename = void>
+		struct has_allocate_at_least : std::false_type
+		{};
+
+		template<typename Alloc>
+		struct has_allocate_at_least<Alloc, typename voider<decltype(std::declval<Alloc&>().allocate_at_least(
+			std::declval<typename Alloc::size_type>()).count)>::type> : std::true_type
+		{};
+
+		// detects an allocator that can resize an existing block itself, realloc() style:
+		// pointer Alloc::reallocate(pointer, size_type oldCount, size_type newCount)
+		// the contents of the old block are preserved (bytewise) in the returned block
+		template<typename Alloc, typename = void>
+		struct has_reallocate : std::false_type
+		{};
+
+		template<typename Alloc>
+		struct has_reallocate<Alloc, typename voider<decltype(std::declval<Alloc&>().reallocate(
+			std::declval<typename Alloc::pointer>(),
+			std::declval<typename Alloc::size_type>(),
+			std::declval<typename Alloc::size_type>()))>::type> : std::true_type
+		{};
+	}
+}
 
-template<typename T, typename Alloc = std::allocator<T>>
+template<typename T, typename Alloc = std::allocator<T>, typename Growth = dbr::growth::Double, typename Observer = dbr::observe::None>
 class DynArray;
 
-template<typename T, typename Alloc = std::allocator<T>>
-bool operator ==(const DynArray<T, Alloc>&, const DynArray<T, Alloc>&);
+template<typename T, typename Alloc = std::allocator<T>, typename Growth = dbr::growth::Double, typename Observer = dbr::observe::None>
+bool operator ==(const DynArray<T, Alloc, Growth, Observer>&, const DynArray<T, Alloc, Growth, Observer>&);
 
-template<typename T, typename Alloc = std::allocator<T>>
-bool operator !=(const DynArray<T, Alloc>&, const DynArray<T, Alloc>&);
+template<typename T, typename Alloc = std::allocator<T>, typename Growth = dbr::growth::Double, typename Observer = dbr::observe::None>
+bool operator !=(const DynArray<T, Alloc, Growth, Observer>&, const DynArray<T, Alloc, Growth, Observer>&);
 
-template<typename T, typename Alloc = std::allocator<T>>
-void swap(DynArray<T, Alloc>&, DynArray<T, Alloc>&);
+template<typename T, typename Alloc = std::allocator<T>, typename Growth = dbr::growth::Double, typename Observer = dbr::observe::None>
+void swap(DynArray<T, Alloc, Growth, Observer>& lhs, DynArray<T, Alloc, Growth, Observer>& rhs) noexcept(noexcept(lhs.swap(rhs)));
 
-template<typename T, typename Alloc>
-class DynArray
+template<typename T, typename Alloc, typename Growth, typename Observer>
+class DynArray : private Observer
 {
 	public:
 		// aliases
-		using ReallocCallback = std::function<void(const T const*, std::size_t)>;
+		using ReallocCallback = std::function<void(const T*, std::size_t)>;
+		using ReallocStats = dbr::ReallocStats;
 		using allocator_type = Alloc;
 		using value_type = typename Alloc::value_type;
 		using reference = typename Alloc::reference;
@@ -29,6 +296,9 @@ class DynArray
 		using difference_type = typename Alloc::difference_type;
 		using size_type = typename Alloc::size_type;
 
+		// declared up front, so iterator's friend declaration finds it
+		class const_iterator;
+
 		class iterator
 		{
 			public:
@@ -46,26 +316,20 @@ class DynArray
 				iterator& operator =(const iterator&);
 
 				// query
-				operator bool() const;
+				explicit operator bool() const;
 
 				// comparisons
-				template<T, Alloc>
-				friend bool operator ==(const iterator&, const iterator&);
+				bool operator ==(const iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator !=(const iterator&, const iterator&);
+				bool operator !=(const iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator <(const iterator&, const iterator&);
+				bool operator <(const iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator >(const iterator&, const iterator&);
+				bool operator >(const iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator <=(const iterator&, const iterator&);
+				bool operator <=(const iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator >=(const iterator&, const iterator&);
+				bool operator >=(const iterator&) const;
 
 				// iteration
 				iterator& operator ++();	// prefix
@@ -75,18 +339,16 @@ class DynArray
 				iterator& operator +=(size_type);
 				iterator& operator -=(size_type);
 
-				template<T, Alloc>
-				friend iterator operator +(const iterator&, size_type);
-
-				template<T, Alloc>
-				friend iterator operator +(size_type, const iterator&);
+				iterator operator +(size_type) const;
+				iterator operator -(size_type) const;
 
-				template<T, Alloc>
-				friend iterator operator -(const iterator&, size_type);
+				friend iterator operator +(size_type lhs, const iterator& rhs)
+				{
+					return rhs + lhs;
+				}
 
 				// distance between iterators
-				template<T, Alloc>
-				friend size_type operator -(const iterator&, const iterator&);
+				difference_type operator -(const iterator&) const;
 
 				reference operator *();
 				const_reference operator *() const;
@@ -94,6 +356,8 @@ class DynArray
 				const_pointer operator ->() const;
 
 			private:
+				friend class const_iterator;
+
 				pointer value;
 		};
 
@@ -116,26 +380,20 @@ class DynArray
 				const_iterator& operator =(const iterator&);
 
 				// query
-				operator bool() const;
+				explicit operator bool() const;
 
 				// comparisons
-				template<T, Alloc>
-				friend bool operator ==(const const_iterator&, const const_iterator&);
+				bool operator ==(const const_iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator !=(const const_iterator&, const const_iterator&);
+				bool operator !=(const const_iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator <(const const_iterator&, const const_iterator&);
+				bool operator <(const const_iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator >(const const_iterator&, const const_iterator&);
+				bool operator >(const const_iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator <=(const const_iterator&, const const_iterator&);
+				bool operator <=(const const_iterator&) const;
 
-				template<T, Alloc>
-				friend bool operator >=(const const_iterator&, const const_iterator&);
+				bool operator >=(const const_iterator&) const;
 
 				// iteration
 				const_iterator& operator ++();		// prefix
@@ -145,18 +403,16 @@ class DynArray
 				const_iterator& operator +=(size_type);
 				const_iterator& operator -=(size_type);
 
-				template<T, Alloc>
-				friend const_iterator operator +(const const_iterator&, size_type);
-
-				template<T, Alloc>
-				friend const_iterator operator +(size_type, const const_iterator&);
+				const_iterator operator +(size_type) const;
+				const_iterator operator -(size_type) const;
 
-				template<T, Alloc>
-				friend const_iterator operator -(const const_iterator&, size_type);
+				friend const_iterator operator +(size_type lhs, const const_iterator& rhs)
+				{
+					return rhs + lhs;
+				}
 
 				// distance between iterators
-				template<T, Alloc>
-				friend size_type operator -(const const_iterator&, const const_iterator&);
+				difference_type operator -(const const_iterator&) const;
 
 				const_reference operator *() const;
 				const_pointer operator ->() const;
@@ -168,20 +424,27 @@ class DynArray
 		// constructors
 		DynArray();
 
+		// allocator constructor
+		explicit DynArray(const Alloc&);
+
 		// reserving constructor
-		DynArray(size_type);
+		DynArray(size_type, const Alloc& = Alloc());
 
 		// sizing constructor
-		DynArray(size_type, const_reference);
+		DynArray(size_type, const_reference, const Alloc& = Alloc());
 
 		// initializer list constructor
-		DynArray(std::initializer_list<value_type>);
+		DynArray(std::initializer_list<value_type>, const Alloc& = Alloc());
 
 		// copy constructor
+		// gets a copy of other's allocator (by way of select_on_container_copy_construction()), so copies of
+		// arrays using an allocator that can't be default constructed (ie: swift::ArenaAllocator) work, and share its memory
 		DynArray(const DynArray&);
 
 		// move constructor
-		DynArray(DynArray&&);
+		// can't throw if it takes the other's block, or the elements fit inside our allocator and moving them can't throw
+		// so arrays of arrays move their elements when they grow, rather than copying them
+		DynArray(DynArray&&) noexcept(nothrowTake::value);
 
 		// initializer list operator
 		DynArray& operator =(std::initializer_list<value_type>);
@@ -190,17 +453,24 @@ class DynArray
 		DynArray& operator =(const DynArray&);
 
 		// move operator
-		DynArray& operator =(DynArray&&);
+		DynArray& operator =(DynArray&&) noexcept(nothrowMoveAssign::value);
 
 		~DynArray();
 
 		// setup functions
+		// only for a dbr::observe::Callback observer
 		void setCallback(const ReallocCallback&);
 
+		Observer& observer();
+		const Observer& observer() const;
+
+		// only for a dbr::observe::Stats observer
+		ReallocStats stats() const;
+
 		// comparisons
-		friend bool operator ==<T, Alloc>(const DynArray&, const DynArray&);
+		friend bool operator ==<T, Alloc, Growth, Observer>(const DynArray&, const DynArray&);
 
-		friend bool operator !=<T, Alloc>(const DynArray&, const DynArray&);
+		friend bool operator !=<T, Alloc, Growth, Observer>(const DynArray&, const DynArray&);
 
 		// iterators
 		iterator begin();
@@ -229,19 +499,19 @@ class DynArray
 
 		// modifying
 		template<typename... Args>
-		void emplace_front(Args...);
+		void emplace_front(Args&&...);
 
 		template<typename... Args>
-		void emplace_back(Args...);
+		void emplace_back(Args&&...);
 
 		template<typename... Args>
-		iterator emplace(const_iterator, Args...);
+		iterator emplace(const_iterator, Args&&...);
 
 		iterator insert(const_iterator, const_reference);
 		iterator insert(const_iterator, rvalue_reference);
-		iterator insert(const_iterator, size_type, reference);
+		iterator insert(const_iterator, size_type, const_reference);
 
-		template<typename iter>
+		template<typename iter, typename = typename std::enable_if<!std::is_integral<iter>::value>::type>
 		iterator insert(const_iterator, iter, iter);
 		iterator insert(const_iterator, std::initializer_list<value_type>);
 
@@ -251,31 +521,64 @@ class DynArray
 		void push_back(const_reference);
 		void push_back(rvalue_reference);
 
+		// closes the gap by sliding whichever side of it has fewer elements
 		iterator erase(const_iterator);
 		iterator erase(const_iterator, const_iterator);
 
+		// removes every element "pred" is true for in one pass, keeping the rest in order, and returns how many that was
+		// for scattered removals, instead of an erase() (and a slide) per element
+		template<typename Pred>
+		size_type erase_if(Pred pred);
+
+		// O(1) erase that doesn't keep the order: the last element is moved into the erased one's place
+		// returns an iterator to that position (end() if it was the last element)
+		iterator swap_erase(const_iterator);
+
 		void pop_front();
 		void pop_back();
 
 		void clear();
 
-		template<typename iter>
+		template<typename iter, typename = typename std::enable_if<!std::is_integral<iter>::value>::type>
 		void assign(iter, iter);
 		void assign(std::initializer_list<value_type>);
 		void assign(size_type, const_reference);
 
 		// other operations
-		void swap(DynArray&);
+		void swap(DynArray&) noexcept(nothrowTake::value);
 		void reserve(size_type);
 		void resize(size_type);
 
+		// makes sure there is room for at least n elements before the first one
+		void reserveFront(size_type);
+
+		// gives back all of the room around the elements, front and back
+		void shrink_to_fit();
+
+		// resize, but new elements are default-initialized instead of value-initialized
+		// ie: trivial types (ints, PODs, etc) are left uninitialized, for when they're about to be overwritten anyways
+		void resizeUninitialized(size_type);
+
+		// for writing straight into the array (ie: from a socket or decoder)
+		// prepare makes room for at least n more elements at the back, and returns where to write them
+		// commit then adds the first n of them to the array. They must be constructed by then,
+		// which for trivial types just means written to
+		// any other modification in between invalidates the prepared memory
+		pointer prepare(size_type);
+		void commit(size_type);
+
 		// queries
-		size_type size();
-		size_type capacity();
-		size_type max_size();
-		bool empty();
+		size_type size() const;
+		size_type capacity() const;
+		size_type frontCapacity() const;
+		size_type max_size() const;
+		bool empty() const;
 
 	private:
+		// pointer to the first allocated address
+		// anything between here and start is headroom for pushing to the front
+		pointer firstAddr;
+
 		// pointer to address of first element
 		pointer start;
 
@@ -287,1015 +590,1841 @@ class DynArray
 
 		Alloc allocator;
 
-		// function that gets called every time the begin pointer is moved
-		// accepts a pointer (which will be the new begin address)
-		// and the current size of the DynArray
-		ReallocCallback reallocCallback;
+		// elements can be moved with a memcpy
+		using relocatable = std::integral_constant<bool, dbr::is_trivially_relocatable<value_type>::value>;
+
+		// elements can be slid around within a block without any chance of losing some halfway through
+		using slidable = std::integral_constant<bool, relocatable::value || std::is_nothrow_move_constructible<value_type>::value>;
+
+		// the allocator can resize our block for us (only worth it if we'd memcpy the elements anyways)
+		using resizable = std::integral_constant<bool, relocatable::value && dbr::impl::has_reallocate<Alloc>::value>;
 
-		static constexpr size_type INITIAL_SIZE = 8;
-		static constexpr float GROWTH_FACTOR = 2.0;
+		// take() can't throw: either any of our allocators can free any other's block, so it's just taken,
+		// or there's room for the elements inside our allocator, and they can be moved without throwing
+		using nothrowTake = std::integral_constant<bool, std::allocator_traits<Alloc>::is_always_equal::value
+		                                                 || (dbr::has_inline_storage<Alloc>::value && slidable::value)>;
+
+		// move assignment can't throw: it takes the other's allocator along with its block, or take() can't throw
+		using nothrowMoveAssign = std::integral_constant<bool, std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value
+		                                                       || nothrowTake::value>;
+
+		// gets a block for at least "n" elements from the allocator
+		// "n" is updated with how many elements the block can actually hold
+		pointer allocateBlock(size_type& n);
+		pointer allocateBlock(size_type& n, std::true_type);
+		pointer allocateBlock(size_type& n, std::false_type);
+
+		// takes the elements of "other" (for moves)
+		void take(DynArray& other);
+
+		// move assignment's half of the allocator: replaces ours with other's, if Alloc propagates on move assignment
+		void moveAllocator(DynArray& other, std::true_type);
+		void moveAllocator(DynArray& other, std::false_type);
+
+		// the capacity to grow to when we're full
+		size_type grownCapacity() const;
+
+		// tells the observer that the elements moved ("newBlock" if to a new block)
+		void recordMove(bool newBlock, size_type bytesCopied);
+
+		// make room for at least one more element before start/after last
+		// slides the elements over if the other end has plenty of room, otherwise reallocates
+		// with all of the new room put at the end that ran out
+		void growFront();
+		void growBack();
+
+		// moves the elements so that the first one is at "to", within the current block
+		// only for slidable types
+		void slide(pointer to);
+
+		// moves our elements into a block of (at least) "newCap" elements, leaving "front" unused slots before them
+		void reallocate(size_type newCap, size_type front);
+
+		pointer resizeBlock(size_type newCap, std::true_type);
+		pointer resizeBlock(size_type newCap, std::false_type);
+
+		// moves "n" elements starting at "from" to the uninitialized memory at "to", and ends the lifetimes of the originals
+		// if it throws, the originals are left as they were
+		static void relocate(pointer from, size_type n, pointer to, std::true_type);
+		static void relocate(pointer from, size_type n, pointer to, std::false_type);
+
+		// same as relocate, but the ranges may overlap
+		static void shift(pointer from, size_type n, pointer to, std::true_type);
+		static void shift(pointer from, size_type n, pointer to, std::false_type);
+
+		// replaces our elements with "n" copies of the elements starting at "first"
+		template<typename iter>
+		void copyFrom(iter first, size_type n);
+
+		// copy constructs "n" elements starting at "first" into the uninitialized memory at "to"
+		// if one throws, the ones already made are destroyed
+		// contiguous ranges of trivially copyable elements are one memcpy
+		template<typename iter>
+		static void copyConstruct(iter first, size_type n, pointer to);
+		static void copyConstruct(const_pointer first, size_type n, pointer to);
+		static void copyConstruct(pointer first, size_type n, pointer to);
+		static void copyConstruct(iterator first, size_type n, pointer to);
+		static void copyConstruct(const_iterator first, size_type n, pointer to);
+		static void copyConstruct(const_pointer first, size_type n, pointer to, std::true_type);
+		static void copyConstruct(const_pointer first, size_type n, pointer to, std::false_type);
+
+		// opens "n" uninitialized slots at "index", and has "fill" construct the new elements in them
+		// slides whichever side of "index" is cheaper if there's room for it, otherwise grows once
+		// "fill" must either construct all "n" elements, or throw having constructed none of them
+		template<typename Fill>
+		pointer insertGap(size_type index, size_type n, Fill fill);
+
+		template<typename iter>
+		iterator insertRange(const_iterator, iter, iter, std::input_iterator_tag);
+
+		template<typename iter>
+		iterator insertRange(const_iterator, iter, iter, std::forward_iterator_tag);
+
+		template<typename iter>
+		void assignRange(iter, iter, std::input_iterator_tag);
+
+		template<typename iter>
+		void assignRange(iter, iter, std::forward_iterator_tag);
+
+		// makes sure there's room for "n" more elements at the back, growing geometrically if not
+		void reserveBack(size_type n);
+
+		static void defaultConstruct(pointer from, pointer to, std::true_type);
+		static void defaultConstruct(pointer from, pointer to, std::false_type);
+
+		// removes the elements in [from, to), and returns where the element after them ended up
+		// relocatable types are slid over with one memmove, everything else is move assigned over the gap
+		pointer closeGap(pointer from, pointer to, std::true_type);
+		pointer closeGap(pointer from, pointer to, std::false_type);
+
+		// erase_if's compaction. Returns the new last
+		// relocatable types are moved in runs, one memmove per run of kept elements
+		template<typename Pred>
+		pointer compact(Pred& pred, std::true_type);
+
+		template<typename Pred>
+		pointer compact(Pred& pred, std::false_type);
+
+		// replaces the element at "to" with the one at "from", ending the lifetime of the one at "from"
+		static void moveOver(pointer from, pointer to, std::true_type);
+		static void moveOver(pointer from, pointer to, std::false_type);
+
+		// trivially destructible types have nothing to destroy, so it's skipped altogether
+		static void destroy(pointer from, pointer to);
+		static void destroy(pointer from, pointer to, std::true_type);
+		static void destroy(pointer from, pointer to, std::false_type);
 };
 
 // iterator
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::iterator::iterator()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::iterator::iterator()
 :	value(nullptr)
 {}
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::iterator::iterator(pointer ptr)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::iterator::iterator(pointer ptr)
 :	value(ptr)
 {}
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::iterator::iterator(const iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::iterator::iterator(const iterator& other)
 :	value(other.value)
 {}
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator& DynArray<T, Alloc>::iterator::operator =(const iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator& DynArray<T, Alloc, Growth, Observer>::iterator::operator =(const iterator& other)
 {
 	value = other.value;
+	return *this;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::iterator::operator bool() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::iterator::operator bool() const
 {
 	return value;
 }
 
-template<typename T, typename Alloc>
-bool operator ==(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator ==(const iterator& other) const
 {
-	return lhs.value == rhs.value;
+	return value == other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator !=(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator !=(const iterator& other) const
 {
-	return !(lhs == rhs);
+	return !(*this == other);
 }
 
-template<typename T, typename Alloc>
-bool operator <(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator <(const iterator& other) const
 {
-	return lhs.value < rhs.value;
+	return value < other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator >(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator >(const iterator& other) const
 {
-	return lhs.value > rhs.value;
+	return value > other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator <=(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator <=(const iterator& other) const
 {
-	return lhs.value <= rhs.value;
+	return value <= other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator >=(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::iterator::operator >=(const iterator& other) const
 {
-	return lhs.value >= rhs.value;
+	return value >= other.value;
 }
 
 // prefix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator& DynArray<T, Alloc>::iterator::operator ++()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator& DynArray<T, Alloc, Growth, Observer>::iterator::operator ++()
 {
-	value += sizeof(value_type);
+	++value;
 	return *this;
 }
 
 // postfix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::iterator::operator ++(int)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::iterator::operator ++(int)
 {
 	pointer temp = value;
-	value += sizeof(value_type);
+	++value;
 	return {temp};
 }
 
 // prefix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator& DynArray<T, Alloc>::iterator::operator --()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator& DynArray<T, Alloc, Growth, Observer>::iterator::operator --()
 {
-	value -= sizeof(value_type);
+	--value;
 	return *this;
 }
 
 // postfix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::iterator::operator --(int)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::iterator::operator --(int)
 {
 	pointer temp = value;
-	value -= sizeof(value_type);
+	--value;
 	return {temp};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator& DynArray<T, Alloc>::iterator::operator +=(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator& DynArray<T, Alloc, Growth, Observer>::iterator::operator +=(size_type n)
 {
-	value += sizeof(value_type) * n;
+	value += n;
 	return *this;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator& DynArray<T, Alloc>::iterator::operator -=(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator& DynArray<T, Alloc, Growth, Observer>::iterator::operator -=(size_type n)
 {
-	value -= sizeof(value_type) * n;
+	value -= n;
 	return *this;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator operator +(const typename DynArray<T, Alloc>::iterator& lhs, typename DynArray<T, Alloc>::size_type rhs)
-{
-	return {lhs.value + sizeof(typename DynArray<T, Alloc>::value_type) * rhs};
-}
-
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator operator +(typename DynArray<T, Alloc>::size_type lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::iterator::operator +(size_type n) const
 {
-	return rhs + lhs;
+	return {value + n};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator operator -(const typename DynArray<T, Alloc>::iterator& lhs, typename DynArray<T, Alloc>::size_type rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::iterator::operator -(size_type n) const
 {
-	return {lhs.value - sizeof(typename DynArray<T, Alloc>::value_type) * rhs};
+	return {value - n};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::size_type operator -(const typename DynArray<T, Alloc>::iterator& lhs, const typename DynArray<T, Alloc>::iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::difference_type DynArray<T, Alloc, Growth, Observer>::iterator::operator -(const iterator& other) const
 {
-	return lhs.value - rhs.value;
+	return value - other.value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::reference DynArray<T, Alloc>::iterator::operator *()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::reference DynArray<T, Alloc, Growth, Observer>::iterator::operator *()
 {
 	return *value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::iterator::operator *() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::iterator::operator *() const
 {
 	return *value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::pointer DynArray<T, Alloc>::iterator::operator ->()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::iterator::operator ->()
 {
 	return value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_pointer DynArray<T, Alloc>::iterator::operator ->() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_pointer DynArray<T, Alloc, Growth, Observer>::iterator::operator ->() const
 {
 	return value;
 }
 
 // const_iterator
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::const_iterator::const_iterator()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::const_iterator::const_iterator()
 :	value(nullptr)
 {}
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::const_iterator::const_iterator(pointer ptr)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::const_iterator::const_iterator(pointer ptr)
 :	value(ptr)
 {}
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::const_iterator::const_iterator(const iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::const_iterator::const_iterator(const iterator& other)
 :	value(other.value)
 {}
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::const_iterator::const_iterator(const const_iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::const_iterator::const_iterator(const const_iterator& other)
 :	value(other.value)
 {}
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator =(const const_iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator =(const const_iterator& other)
 {
 	value = other.value;
+	return *this;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator =(const iterator& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator =(const iterator& other)
 {
 	value = other.value;
+	return *this;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::const_iterator::operator bool() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::const_iterator::operator bool() const
 {
 	return value;
 }
 
-template<typename T, typename Alloc>
-bool operator ==(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator ==(const const_iterator& other) const
 {
-	return lhs.value == rhs.value;
+	return value == other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator !=(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator !=(const const_iterator& other) const
 {
-	return !(lhs == rhs);
+	return !(*this == other);
 }
 
-template<typename T, typename Alloc>
-bool operator <(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator <(const const_iterator& other) const
 {
-	return lhs.value < rhs.value;
+	return value < other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator >(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator >(const const_iterator& other) const
 {
-	return lhs.value > rhs.value;
+	return value > other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator <=(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator <=(const const_iterator& other) const
 {
-	return lhs.value <= rhs.value;
+	return value <= other.value;
 }
 
-template<typename T, typename Alloc>
-bool operator >=(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::const_iterator::operator >=(const const_iterator& other) const
 {
-	return lhs.value >= rhs.value;
+	return value >= other.value;
 }
 
 // prefix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator ++()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator ++()
 {
-	value += sizeof(value_type);
+	++value;
 	return *this;
 }
 
 // postfix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::const_iterator::operator ++(int)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::const_iterator::operator ++(int)
 {
 	pointer temp = value;
-	value += sizeof(value_type);
+	++value;
 	return {temp};
 }
 
 // prefix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator --()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator --()
 {
-	value -= sizeof(value_type);
+	--value;
 	return *this;
 }
 
 // postfix
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::const_iterator::operator --(int)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::const_iterator::operator --(int)
 {
 	pointer temp = value;
-	value -= sizeof(value_type);
+	--value;
 	return {temp};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator +=(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator +=(size_type n)
 {
-	value += sizeof(value_type) * n;
+	value += n;
 	return *this;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator& DynArray<T, Alloc>::const_iterator::operator -=(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator& DynArray<T, Alloc, Growth, Observer>::const_iterator::operator -=(size_type n)
 {
-	value -= sizeof(value_type) * n;
+	value -= n;
 	return *this;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator operator +(const typename DynArray<T, Alloc>::const_iterator& lhs, typename DynArray<T, Alloc>::size_type rhs)
-{
-	return {lhs.value + sizeof(typename DynArray<T, Alloc>::value_type) * rhs};
-}
-
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator operator +(typename DynArray<T, Alloc>::size_type lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::const_iterator::operator +(size_type n) const
 {
-	return rhs + lhs;
+	return {value + n};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator operator -(const typename DynArray<T, Alloc>::const_iterator& lhs, typename DynArray<T, Alloc>::size_type rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::const_iterator::operator -(size_type n) const
 {
-	return {lhs.value - sizeof(typename DynArray<T, Alloc>::value_type) * rhs};
+	return {value - n};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::size_type operator -(const typename DynArray<T, Alloc>::const_iterator& lhs, const typename DynArray<T, Alloc>::const_iterator& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::difference_type DynArray<T, Alloc, Growth, Observer>::const_iterator::operator -(const const_iterator& other) const
 {
-	return lhs.value - rhs.value;
+	return value - other.value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::const_iterator::operator *() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::const_iterator::operator *() const
 {
 	return *value;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_pointer DynArray<T, Alloc>::const_iterator::operator ->() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_pointer DynArray<T, Alloc, Growth, Observer>::const_iterator::operator ->() const
 {
 	return value;
 }
 
 // DynArray
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray()
 {
-	start = allocator.allocate(INITIAL_SIZE);
+	size_type cap = Growth::initial(sizeof(value_type));
+
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
 	last = start;
-	lastAddr = start + sizeof(value_type) * INITIAL_SIZE;
+	lastAddr = firstAddr + cap;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(const Alloc& alloc)
+:	allocator(alloc)
 {
-	start = allocator.allocate(n);
+	size_type cap = Growth::initial(sizeof(value_type));
+
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
 	last = start;
-	lastAddr = start + sizeof(value_type) * n;
+	lastAddr = firstAddr + cap;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray(size_type n, const_reference val)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(size_type n, const Alloc& alloc)
+:	allocator(alloc)
 {
-	start = allocator.allocate(n);
-	last = start + sizeof(value_type) * n;
-	lastAddr = last;
+	size_type cap = n;
 
-	iterator end(last);
-	for(iterator it(start); it != end; ++it)
-		*it = val;
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
+	last = start;
+	lastAddr = firstAddr + cap;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray(std::initializer_list<value_type> ilist)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(size_type n, const_reference val, const Alloc& alloc)
+:	allocator(alloc)
 {
-	constexpr auto size = ilist.size();
+	size_type cap = n;
 
-	start = allocator.allocate(size);
-	last = start + sizeof(value_type) * size;
-	lastAddr = last;
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
+	last = start + n;
+	lastAddr = firstAddr + cap;
 
-	iterator it(start);
-	for(auto ilistIt = ilist.begin(); ilistIt != ilist.end(); ++ilistIt, ++it)
-		*it = *ilistIt;
+	try
+	{
+		std::uninitialized_fill(start, last, val);
+	}
+	catch(...)
+	{
+		allocator.deallocate(firstAddr, cap);
+		throw;
+	}
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray(const DynArray& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(std::initializer_list<value_type> ilist, const Alloc& alloc)
+:	allocator(alloc)
 {
-	constexpr auto size = other.size();
+	const size_type size = ilist.size();
+	size_type cap = size;
 
-	start = allocator.allocate(size);
-	last = start + sizeof(value_type) * size;
-	lastAddr = last;
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
+	last = start + size;
+	lastAddr = firstAddr + cap;
 
-	iterator it(start);
-	iterator end(other.last);
-	for(iterator otherIt(other.start); otherIt != end; ++otherIt, ++it)
-		*it = *otherIt;
+	try
+	{
+		std::uninitialized_copy(ilist.begin(), ilist.end(), start);
+	}
+	catch(...)
+	{
+		allocator.deallocate(firstAddr, cap);
+		throw;
+	}
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::DynArray(DynArray&& other)
-:	allocator(std::move(other.allocator))
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(const DynArray& other)
+:	allocator(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.allocator))
 {
-	start = other.start;
-	last = other.last;
-	lastAddr = other.lastAddr;
+	const size_type size = other.size();
+	size_type cap = size;
 
-	other.start = nullptr;
-	other.last = nullptr;
-	other.lastAddr = nullptr;
-}
+	firstAddr = allocateBlock(cap);
+	start = firstAddr;
+	last = start + size;
+	lastAddr = firstAddr + cap;
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>::~DynArray()
-{
-	if(start && last)
+	try
 	{
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
+		std::uninitialized_copy(other.start, other.last, start);
+	}
+	catch(...)
+	{
+		allocator.deallocate(firstAddr, cap);
+		throw;
 	}
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>& DynArray<T, Alloc>::operator =(std::initializer_list<value_type> ilist)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::DynArray(DynArray&& other) noexcept(nothrowTake::value)
+:	allocator(std::move(other.allocator))
 {
-	constexpr auto ilistSize = ilist.size();
+	take(other);
+}
 
-	// if we can fit the ilist in our already allocated memory, don't allocate
-	if(ilist.size() <= (lastAddr - start) / sizeof(value_type))
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>::~DynArray()
+{
+	if(firstAddr)
 	{
-		iterator it(start);
-		for(auto ilistIt = ilist.begin(); ilistIt != ilist.end(); ++ilistIt, ++it)
-			*it = *ilistIt;
-
-		last = it;
+		destroy(start, last);
+		allocator.deallocate(firstAddr, lastAddr - firstAddr);
 	}
-	// if not, then reallocate
-	else
-	{
-		if(start && lastAddr)
-			allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
-
-		start = allocator.allocate(ilistSize);
-		last = start + sizeof(value_type) * ilistSize;
-		lastAddr = last;
+}
 
-		// if we have a reallocation callback, call it with the new data
-		if(reallocCallback)
-			reallocCallback(start, (last - start) / sizeof(value_type));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>& DynArray<T, Alloc, Growth, Observer>::operator =(std::initializer_list<value_type> ilist)
+{
+	copyFrom(ilist.begin(), ilist.size());
+	return *this;
+}
 
-		iterator it(start);
-		for(auto ilistIt = ilist.begin(); ilistIt != ilist.end(); ++ilistIt, ++it)
-			*it = *ilistIt;
-	}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>& DynArray<T, Alloc, Growth, Observer>::operator =(const DynArray& other)
+{
+	if(this != &other)
+		copyFrom(other.start, other.last - other.start);
 
 	return *this;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>& DynArray<T, Alloc>::operator =(const DynArray& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+DynArray<T, Alloc, Growth, Observer>& DynArray<T, Alloc, Growth, Observer>::operator =(DynArray&& other) noexcept(nothrowMoveAssign::value)
 {
-	constexpr auto otherSize = other.size();
+	if(this == &other)
+		return *this;
 
-	if(otherSize <= (lastAddr - start) / sizeof(value_type))
+	// deallocate our current memory if needed
+	if(firstAddr)
 	{
-		iterator it(start);
-		for(auto otherIt = other.begin(); otherIt != other.end(); ++otherIt, ++it)
-			*it = *otherIt;
-
-		last = it;
+		destroy(start, last);
+		allocator.deallocate(firstAddr, lastAddr - firstAddr);
+
+		// empty, in case taking the other's elements throws
+		firstAddr = nullptr;
+		start = nullptr;
+		last = nullptr;
+		lastAddr = nullptr;
 	}
-	else
-	{
-		if(start && lastAddr)
-			allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
 
-		start = allocator.allocate(otherSize);
-		last = start + sizeof(value_type) * otherSize;
-		lastAddr = last;
-
-		// if we have a reallocation callback, call it with the new data
-		if(reallocCallback)
-			reallocCallback(start, (last - start) / sizeof(value_type));
-
-		iterator it(start);
-		for(auto otherIt = other.begin(); otherIt != other.end(); ++otherIt, ++it)
-			*it = *otherIt;
-	}
+	// if we keep our allocator and it can't free the other's block, take() moves the elements over one by one
+	moveAllocator(other, typename std::allocator_traits<Alloc>::propagate_on_container_move_assignment{});
+	take(other);
 
 	return *this;
 }
 
-template<typename T, typename Alloc>
-DynArray<T, Alloc>& DynArray<T, Alloc>::operator =(DynArray&& other)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::setCallback(const ReallocCallback& rc)
 {
-	// deallocate our current memory if needed
-	if(start && lastAddr)
-		allocator.deallocate((lastAddr - start) / sizeof(value_type));
+	observer().setCallback(rc);
+}
 
-	allocator = std::move(other.allocator);
-	start = other.start;
-	last = other.last;
-	lastAddr = other.lastAddr;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+Observer& DynArray<T, Alloc, Growth, Observer>::observer()
+{
+	return *this;
+}
 
-	other.start = nullptr;
-	other.last = nullptr;
-	other.lastAddr = nullptr;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+const Observer& DynArray<T, Alloc, Growth, Observer>::observer() const
+{
+	return *this;
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::setCallback(const ReallocCallback& rc)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::ReallocStats DynArray<T, Alloc, Growth, Observer>::stats() const
 {
-	reallocCallback = rc;
+	// the observer only sees the capacity when something moves, the first block may be the biggest so far
+	ReallocStats current = observer().stats();
+
+	const size_type cap = lastAddr - firstAddr;
+	if(cap > current.peakCapacity)
+		current.peakCapacity = cap;
+
+	return current;
 }
 
-template<typename T, typename Alloc>
-bool operator ==(const DynArray<T, Alloc>& lhs, const DynArray<T, Alloc>& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool operator ==(const DynArray<T, Alloc, Growth, Observer>& lhs, const DynArray<T, Alloc, Growth, Observer>& rhs)
 {
 	return lhs.start == rhs.start && lhs.last == rhs.last && lhs.lastAddr == rhs.lastAddr;
 }
 
-template<typename T, typename Alloc>
-bool operator !=(const DynArray<T, Alloc>& lhs, const DynArray<T, Alloc>& rhs)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool operator !=(const DynArray<T, Alloc, Growth, Observer>& lhs, const DynArray<T, Alloc, Growth, Observer>& rhs)
 {
 	return !(lhs == rhs);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::begin()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::begin()
 {
 	return {start};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::begin() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::begin() const
 {
 	return {start};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::cbegin() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::cbegin() const
 {
 	return {start};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::end()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::end()
 {
-	return {end};
+	return {last};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::end() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::end() const
 {
-	return {end};
+	return {last};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_iterator DynArray<T, Alloc>::cend() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_iterator DynArray<T, Alloc, Growth, Observer>::cend() const
 {
-	return {end};
+	return {last};
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::reference DynArray<T, Alloc>::front()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::reference DynArray<T, Alloc, Growth, Observer>::front()
 {
 	return *start;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::front() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::front() const
 {
 	return *start;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::reference DynArray<T, Alloc>::back()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::reference DynArray<T, Alloc, Growth, Observer>::back()
 {
-	return *(last - sizeof(value_type));
+	return *(last - 1);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::back() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::back() const
 {
-	return *(last - sizeof(value_type));
+	return *(last - 1);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::reference DynArray<T, Alloc>::at(size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::reference DynArray<T, Alloc, Growth, Observer>::at(size_type n)
 {
-	return *(start + sizeof(value_type) * n);
+	return *(start + n);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::at(size_type n) const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::at(size_type n) const
 {
-	return *(start + sizeof(value_type) * n);
+	return *(start + n);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::reference DynArray<T, Alloc>::operator [](size_type n)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::reference DynArray<T, Alloc, Growth, Observer>::operator [](size_type n)
 {
-	return *(start + sizeof(value_type) * n);
+	return *(start + n);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_reference DynArray<T, Alloc>::operator [](size_type n) const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_reference DynArray<T, Alloc, Growth, Observer>::operator [](size_type n) const
 {
-	return *(start + sizeof(value_type) * n);
+	return *(start + n);
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::pointer DynArray<T, Alloc>::data()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::data()
 {
 	return start;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::const_pointer DynArray<T, Alloc>::data() const
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::const_pointer DynArray<T, Alloc, Growth, Observer>::data() const
 {
 	return start;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, typename Growth, typename Observer>
 template<typename... Args>
-void DynArray<T, Alloc>::emplace_front(Args... args)
+void DynArray<T, Alloc, Growth, Observer>::emplace_front(Args&&... args)
 {
-	// reallocate if we need to
-	if(last == lastAddr)
+	// make room at the front if we need to
+	if(start == firstAddr)
 	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
-
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
-
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart + sizeof(value_type));	// we're emplacing on the front, so skip the first available
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
+		// args may refer to one of our elements, so make the new one before they're moved
+		value_type temp(std::forward<Args>(args)...);
+		growFront();
 
-		// get it's pointer value
-		newLast = it.operator ->();
-
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
-
-		// put new element at the front
-		new (newStart) value_type(args...);
-
-		start = newStart;
-		last = newLast;
-		lastAddr = newLastAddr;
+		new (start - 1) value_type(std::move(temp));
 	}
-	// if we don't, just shift everything up
 	else
 	{
-		iterator f(start);
-		iterator it(last);
-		for(; it != f; --it)
-			new (it.operator ->()) value_type(*(it - 1));
-
-		// shift last up 1
-		last += sizeof(value_type);
-
-		// now create new element
-		new (start) value_type(args...);
+		new (start - 1) value_type(std::forward<Args>(args)...);
 	}
+
+	// shift start down 1
+	--start;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, typename Growth, typename Observer>
 template<typename... Args>
-void DynArray<T, Alloc>::emplace_back(Args... args)
+void DynArray<T, Alloc, Growth, Observer>::emplace_back(Args&&... args)
 {
-	// reallocate if we need to
+	// make room at the back if we need to
 	if(last == lastAddr)
 	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
-
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
+		// args may refer to one of our elements, so make the new one before they're moved
+		value_type temp(std::forward<Args>(args)...);
+		growBack();
 
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart);
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
-
-		// get it's pointer value
-		newLast = it.operator ->();
-
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
-
-		start = newStart;
-		last = newLast;
-		lastAddr = newLastAddr;
+		new (last) value_type(std::move(temp));
+	}
+	else
+	{
+		new (last) value_type(std::forward<Args>(args)...);
 	}
-
-	// now add new element
-	new (last) value_type(args...);
 
 	// shift last up 1
-	last += sizeof(value_type);
+	++last;
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, typename Growth, typename Observer>
 template<typename... Args>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::emplace(const_iterator, Args...)
-{}
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::emplace(const_iterator pos, Args&&... args)
+{
+	// args may refer to one of our elements, so make the new one before anything is moved
+	value_type temp(std::forward<Args>(args)...);
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::insert(const_iterator, const_reference)
-{}
+	return {insertGap(pos - cbegin(), 1, [&temp](pointer to)
+	{
+		new (to) value_type(std::move(temp));
+	})};
+}
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::insert(const_iterator, rvalue_reference)
-{}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insert(const_iterator pos, const_reference ref)
+{
+	return emplace(pos, ref);
+}
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::insert(const_iterator, size_type, reference)
-{}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insert(const_iterator pos, rvalue_reference rref)
+{
+	return emplace(pos, std::move(rref));
+}
 
-template<typename T, typename Alloc>
-template<typename iter>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::insert(const_iterator, iter, iter)
-{}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insert(const_iterator pos, size_type n, const_reference ref)
+{
+	const value_type temp(ref);
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::insert(const_iterator, std::initializer_list<value_type>)
-{}
+	return {insertGap(pos - cbegin(), n, [&temp, n](pointer to)
+	{
+		std::uninitialized_fill_n(to, n, temp);
+	})};
+}
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::push_front(const_reference ref)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter, typename>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insert(const_iterator pos, iter first, iter last)
 {
-	// reallocate if we need to
-	if(last == lastAddr)
-	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
+	return insertRange(pos, first, last, typename std::iterator_traits<iter>::iterator_category{});
+}
 
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insert(const_iterator pos, std::initializer_list<value_type> ilist)
+{
+	return insertRange(pos, ilist.begin(), ilist.end(), std::random_access_iterator_tag{});
+}
 
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart + sizeof(value_type));	// we're emplacing on the front, so skip the first available
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::push_front(const_reference ref)
+{
+	emplace_front(ref);
+}
 
-		// get it's pointer value
-		newLast = it.operator ->();
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::push_front(rvalue_reference rref)
+{
+	emplace_front(std::move(rref));
+}
 
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::push_back(const_reference ref)
+{
+	emplace_back(ref);
+}
 
-		// put new element at the front
-		new (newStart) value_type(ref);
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::push_back(rvalue_reference rref)
+{
+	emplace_back(std::move(rref));
+}
 
-		start = newStart;
-		last = newLast;
-		lastAddr = newLastAddr;
-	}
-	// if we don't, just shift everything up
-	else
-	{
-		iterator f(start);
-		iterator it(last);
-		for(; it != f; --it)
-			new (it.operator ->()) value_type(*(it - 1));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::erase(const_iterator pos)
+{
+	return erase(pos, pos + 1);
+}
 
-		// shift last up 1
-		last += sizeof(value_type);
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::erase(const_iterator from, const_iterator to)
+{
+	pointer first = start + (from - cbegin());
+	pointer end = start + (to - cbegin());
 
-		// now create new element
-		new (start) value_type(ref);
-	}
+	if(first == end)
+		return {first};
+
+	return {closeGap(first, end, relocatable{})};
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::push_front(rvalue_reference rref)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename Pred>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::erase_if(Pred pred)
 {
-	// reallocate if we need to
-	if(last == lastAddr)
-	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
-
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
+	const size_type oldSize = last - start;
 
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart + sizeof(value_type));	// we're emplacing on the front, so skip the first available
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
+	last = compact(pred, relocatable{});
 
-		// get it's pointer value
-		newLast = it.operator ->();
+	return oldSize - (last - start);
+}
 
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::swap_erase(const_iterator pos)
+{
+	pointer at = start + (pos - cbegin());
+	pointer back = last - 1;
 
-		// put new element at the front
-		new (newStart) value_type(rref);
+	if(at != back)
+	{
+		moveOver(back, at, relocatable{});
+		--last;
 
-		start = newStart;
-		last = newLast;
-		lastAddr = newLastAddr;
+		recordMove(false, sizeof(value_type));
 	}
-	// if we don't, just shift everything up
 	else
 	{
-		iterator f(start);
-		iterator it(last);
-		for(; it != f; --it)
-			new (it.operator ->()) value_type(*(it - 1));
-
-		// shift last up 1
-		last += sizeof(value_type);
-
-		// now create new element
-		new (start) value_type(rref);
+		pop_back();
 	}
+
+	return {at};
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::push_back(const_reference ref)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::pop_front()
 {
-	// reallocate if we need to
-	if(last == lastAddr)
-	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
+	// the slot becomes headroom for the front
+	destroy(start, start + 1);
+	++start;
+}
 
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::pop_back()
+{
+	--last;
+	last->~value_type();
+}
 
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart);
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::clear()
+{
+	destroy(start, last);
+	last = start;
+}
 
-		// get it's pointer value
-		newLast = it.operator ->();
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter, typename>
+void DynArray<T, Alloc, Growth, Observer>::assign(iter first, iter last)
+{
+	assignRange(first, last, typename std::iterator_traits<iter>::iterator_category{});
+}
 
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::assign(std::initializer_list<value_type> ilist)
+{
+	copyFrom(ilist.begin(), ilist.size());
+}
 
-		start = newStart;
-		last = newLast;
-		lastAddr = newLastAddr;
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::assign(size_type n, const_reference ref)
+{
+	// ref may be one of our elements
+	const value_type temp(ref);
+
+	clear();
+	reserve(n);
+
+	std::uninitialized_fill_n(start, n, temp);
+	last = start + n;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::swap(DynArray& other) noexcept(nothrowTake::value)
+{
+	if(this == &other)
+		return;
+
+	// either allocator can free either block, so just trade blocks
+	if(allocator == other.allocator)
+	{
+		std::swap(firstAddr, other.firstAddr);
+		std::swap(start, other.start);
+		std::swap(last, other.last);
+		std::swap(lastAddr, other.lastAddr);
+	}
+	// otherwise the blocks have to stay with their allocators, moves take care of that
+	else
+	{
+		DynArray temp(std::move(other));
+		other = std::move(*this);
+		*this = std::move(temp);
 	}
+}
 
-	// now add new element
-	new (last) value_type(ref);
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::reserve(size_type n)
+{
+	const size_type cap = lastAddr - start;
+	if(n <= cap)
+		return;
 
-	// shift last up 1
-	last += sizeof(value_type);
+	// keep whatever headroom we have at the front
+	const size_type front = start - firstAddr;
+	reallocate(front + n, front);
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::push_back(rvalue_reference rref)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::resize(size_type n)
 {
-	// reallocate if we need to
-	if(last == lastAddr)
+	const pointer newLast = start + n;
+
+	if(newLast <= last)
 	{
-		const auto size = (last - start) / sizeof(value_type);
-		const auto newSize = size * GROWTH_FACTOR;
+		destroy(newLast, last);
+		last = newLast;
+		return;
+	}
+
+	reserve(n);
+
+	// value-initialize the new elements, one at a time so we stay consistent if one throws
+	for(pointer end = start + n; last != end; ++last)
+		new (last) value_type();
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::reserveFront(size_type n)
+{
+	const size_type front = start - firstAddr;
+	if(n <= front)
+		return;
+
+	// keep whatever room we have at the back
+	reallocate(n + (lastAddr - start), n);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::shrink_to_fit()
+{
+	const size_type size = last - start;
+	if(size == static_cast<size_type>(lastAddr - firstAddr))
+		return;
 
-		// get our new memory
-		pointer newStart = allocator.allocate(newSize);
-		pointer newLast = newStart;
-		pointer newLastAddr = newStart + sizeof(value_type) * newSize;
+	// no elements, no block
+	if(size == 0)
+	{
+		allocator.deallocate(firstAddr, lastAddr - firstAddr);
 
-		// copy current elements to new memory
-		iterator f(start);
-		iterator it(start);
-		iterator newIt(newStart);
-		iterator end(last);
-		for(; it != end; ++it, ++newIt)
-			*newIt = *it;
+		firstAddr = nullptr;
+		start = nullptr;
+		last = nullptr;
+		lastAddr = nullptr;
+		return;
+	}
 
-		// get it's pointer value
-		newLast = it.operator ->();
+	reallocate(size, 0);
+}
 
-		// get rid of old memory
-		allocator.deallocate(start, (lastAddr - start) / sizeof(value_type));
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::resizeUninitialized(size_type n)
+{
+	const pointer newLast = start + n;
 
-		start = newStart;
+	if(newLast <= last)
+	{
+		destroy(newLast, last);
 		last = newLast;
-		lastAddr = newLastAddr;
+		return;
 	}
 
-	// now add new element
-	new (last) value_type(rref);
+	reserve(n);
 
-	// shift last up 1
-	last += sizeof(value_type);
+	defaultConstruct(last, start + n, std::is_trivially_default_constructible<value_type>{});
+	last = start + n;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::erase(const_iterator)
-{}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::prepare(size_type n)
+{
+	reserveBack(n);
+	return last;
+}
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::iterator DynArray<T, Alloc>::erase(const_iterator, const_iterator)
-{}
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::commit(size_type n)
+{
+	last += n;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::size() const
+{
+	return last - start;
+}
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::pop_front()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::capacity() const
+{
+	return lastAddr - start;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::frontCapacity() const
+{
+	return start - firstAddr;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::max_size() const
+{
+	return std::numeric_limits<size_type>::max() / sizeof(value_type);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+bool DynArray<T, Alloc, Growth, Observer>::empty() const
+{
+	return start == last;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::allocateBlock(size_type& n)
+{
+	return allocateBlock(n, dbr::impl::has_allocate_at_least<Alloc>{});
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::allocateBlock(size_type& n, std::true_type)
+{
+	auto result = allocator.allocate_at_least(n);
+	n = result.count;
+	return result.ptr;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::allocateBlock(size_type& n, std::false_type)
+{
+	return allocator.allocate(n);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::take(DynArray& other)
+{
+	// the other's block is only ours to take if our allocator can free it
+	if(allocator == other.allocator)
+	{
+		firstAddr = other.firstAddr;
+		start = other.start;
+		last = other.last;
+		lastAddr = other.lastAddr;
+
+		other.firstAddr = nullptr;
+		other.start = nullptr;
+		other.last = nullptr;
+		other.lastAddr = nullptr;
+	}
+	// otherwise the block has to stay with the other (ie: it lives inside of its allocator),
+	// so move the elements over to a block of our own
+	else
+	{
+		const size_type size = other.last - other.start;
+		size_type cap = size;
+
+		firstAddr = allocateBlock(cap);
+		start = firstAddr;
+		last = start + size;
+		lastAddr = firstAddr + cap;
+
+		relocate(other.start, size, start, relocatable{});
+		other.last = other.start;
+	}
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::moveAllocator(DynArray& other, std::true_type)
+{
+	allocator = std::move(other.allocator);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::moveAllocator(DynArray&, std::false_type)
 {}
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::pop_back()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::size_type DynArray<T, Alloc, Growth, Observer>::grownCapacity() const
+{
+	const size_type cap = lastAddr - firstAddr;
+	if(!cap)
+		return Growth::initial(sizeof(value_type));
+
+	// always grow by at least one, whatever the policy says
+	const size_type grown = Growth::grow(cap, sizeof(value_type));
+	return grown > cap ? grown : cap + 1;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::recordMove(bool newBlock, size_type bytesCopied)
 {
-	last -= sizeof(value_type);
+	const dbr::MoveEvent event = {newBlock, bytesCopied, static_cast<std::size_t>(lastAddr - firstAddr)};
+	observer()(start, last - start, event);
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::clear()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::growFront()
 {
-	last = start;
+	const size_type size = last - start;
+	const size_type back = lastAddr - last;
+
+	// more room at the back than we have elements, so sliding is cheaper than a new block
+	// moving over by half of it keeps both ends amortized O(1)
+	if(slidable::value && back > size)
+	{
+		slide(start + (back + 1) / 2);
+	}
+	else
+	{
+		const size_type newCap = grownCapacity();
+		reallocate(newCap, newCap - size - back);
+	}
 }
 
-template<typename T, typename Alloc>
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::growBack()
+{
+	const size_type size = last - start;
+	const size_type front = start - firstAddr;
+
+	if(slidable::value && front > size)
+		slide(start - (front + 1) / 2);
+	else
+		reallocate(grownCapacity(), front);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::slide(pointer to)
+{
+	const size_type size = last - start;
+
+	shift(start, size, to, relocatable{});
+
+	start = to;
+	last = to + size;
+
+	recordMove(false, size * sizeof(value_type));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::reallocate(size_type newCap, size_type front)
+{
+	const size_type size = last - start;
+
+	pointer newFirst = nullptr;
+	size_type bytesCopied = 0;
+
+	// the allocator may be able to do it without us copying anything
+	// it keeps the elements where they are in the block, so if the front changes, they're slid over on our side of the resize
+	if(resizable::value && firstAddr)
+	{
+		const size_type oldFront = start - firstAddr;
+
+		if(front < oldFront)
+		{
+			shift(start, size, firstAddr + front, relocatable{});
+			start = firstAddr + front;
+			last = start + size;
+		}
+
+		newFirst = resizeBlock(newCap, resizable{});
+
+		if(front > oldFront)
+			shift(newFirst + oldFront, size, newFirst + front, relocatable{});
+
+		if(front != oldFront)
+			bytesCopied = size * sizeof(value_type);
+	}
+	else
+	{
+		newFirst = allocateBlock(newCap);
+
+		if(firstAddr)
+		{
+			// if moving the elements fails, they're still in the old block, so just give the new one back
+			try
+			{
+				relocate(start, size, newFirst + front, relocatable{});
+			}
+			catch(...)
+			{
+				allocator.deallocate(newFirst, newCap);
+				throw;
+			}
+
+			allocator.deallocate(firstAddr, lastAddr - firstAddr);
+			bytesCopied = size * sizeof(value_type);
+		}
+	}
+
+	firstAddr = newFirst;
+	start = newFirst + front;
+	last = start + size;
+	lastAddr = newFirst + newCap;
+
+	recordMove(true, bytesCopied);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::resizeBlock(size_type newCap, std::true_type)
+{
+	return allocator.reallocate(firstAddr, lastAddr - firstAddr, newCap);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::resizeBlock(size_type, std::false_type)
+{
+	return nullptr;
+}
+
+// trivially relocatable, one bulk copy
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::relocate(pointer from, size_type n, pointer to, std::true_type)
+{
+	std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(value_type));
+}
+
+// everything else, element by element
+// moves if that can't throw, otherwise copies so that the originals are still intact if one does
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::relocate(pointer from, size_type n, pointer to, std::false_type)
+{
+	size_type i = 0;
+
+	try
+	{
+		for(; i != n; ++i)
+			new (to + i) value_type(std::move_if_noexcept(from[i]));
+	}
+	catch(...)
+	{
+		destroy(to, to + i);
+		throw;
+	}
+
+	destroy(from, from + n);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::shift(pointer from, size_type n, pointer to, std::true_type)
+{
+	std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(value_type));
+}
+
+// each element is destroyed right after it's moved, so its slot is free for the ones after it
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::shift(pointer from, size_type n, pointer to, std::false_type)
+{
+	// sliding up, go from the back so we don't overwrite anything we still need
+	if(to > from)
+	{
+		for(size_type i = n; i != 0; --i)
+		{
+			new (to + i - 1) value_type(std::move(from[i - 1]));
+			from[i - 1].~value_type();
+		}
+	}
+	else
+	{
+		for(size_type i = 0; i != n; ++i)
+		{
+			new (to + i) value_type(std::move(from[i]));
+			from[i].~value_type();
+		}
+	}
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
 template<typename iter>
-void DynArray<T, Alloc>::assign(iter, iter)
-{}
+void DynArray<T, Alloc, Growth, Observer>::copyFrom(iter first, size_type n)
+{
+	const size_type size = last - start;
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::assign(std::initializer_list<value_type>)
-{}
+	// if we can fit them in our already allocated memory, don't allocate
+	if(n <= static_cast<size_type>(lastAddr - start) && std::is_trivially_copyable<value_type>::value)
+	{
+		// nothing to assign over or destroy, just copy them in
+		copyConstruct(first, n, start);
+		last = start + n;
+	}
+	else if(n <= static_cast<size_type>(lastAddr - start))
+	{
+		// assign over the elements we already have, then make the rest
+		const size_type overlap = n < size ? n : size;
+		for(size_type i = 0; i != overlap; ++i, ++first)
+			start[i] = *first;
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::assign(size_type, const_reference)
-{}
+		if(n < size)
+		{
+			destroy(start + n, last);
+			last = start + n;
+		}
+		else
+		{
+			for(; last != start + n; ++last, ++first)
+				new (last) value_type(*first);
+		}
+	}
+	// if not, then reallocate
+	else
+	{
+		destroy(start, last);
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::swap(DynArray&)
-{}
+		if(firstAddr)
+			allocator.deallocate(firstAddr, lastAddr - firstAddr);
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::reserve(size_type n)
+		firstAddr = nullptr;
+		start = nullptr;
+		last = nullptr;
+		lastAddr = nullptr;
+
+		size_type cap = n;
+
+		firstAddr = allocateBlock(cap);
+		start = firstAddr;
+		last = start;
+		lastAddr = firstAddr + cap;
+
+		copyConstruct(first, n, start);
+		last = start + n;
+
+		// nothing was moved over, they're all new copies
+		recordMove(true, 0);
+	}
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(iter first, size_type n, pointer to)
 {
-	const auto cap = (lastAddr - start) / sizeof(value_type);
-	if(n <= cap)
+	std::uninitialized_copy_n(first, n, to);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(const_pointer first, size_type n, pointer to)
+{
+	copyConstruct(first, n, to, std::is_trivially_copyable<value_type>{});
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(pointer first, size_type n, pointer to)
+{
+	copyConstruct(const_pointer(first), n, to);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(iterator first, size_type n, pointer to)
+{
+	copyConstruct(first.operator ->(), n, to);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(const_iterator first, size_type n, pointer to)
+{
+	copyConstruct(first.operator ->(), n, to);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(const_pointer first, size_type n, pointer to, std::true_type)
+{
+	if(n)
+		std::memcpy(static_cast<void*>(to), static_cast<const void*>(first), n * sizeof(value_type));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::copyConstruct(const_pointer first, size_type n, pointer to, std::false_type)
+{
+	std::uninitialized_copy_n(first, n, to);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename Fill>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::insertGap(size_type index, size_type n, Fill fill)
+{
+	const size_type size = last - start;
+	const size_type front = start - firstAddr;
+	const size_type back = lastAddr - last;
+
+	// slide the elements before "index" down into the headroom
+	if(slidable::value && n <= front && (index < size - index || n > back))
+	{
+		shift(start, index, start - n, relocatable{});
+		start -= n;
+
+		try
+		{
+			fill(start + index);
+		}
+		catch(...)
+		{
+			// close the gap back up
+			shift(start, index, start + n, relocatable{});
+			start += n;
+			throw;
+		}
+
+		recordMove(false, index * sizeof(value_type));
+		return start + index;
+	}
+
+	// slide the elements after "index" up into the spare room at the back
+	if(slidable::value && n <= back)
+	{
+		shift(start + index, size - index, start + index + n, relocatable{});
+
+		try
+		{
+			fill(start + index);
+		}
+		catch(...)
+		{
+			shift(start + index + n, size - index, start + index, relocatable{});
+			throw;
+		}
+
+		last += n;
+
+		recordMove(false, (size - index) * sizeof(value_type));
+		return start + index;
+	}
+
+	// doesn't fit (or can't be slid into place without risking a throw half way), so build the result in a new block:
+	// new elements first, then the old ones around them. Only grown if it doesn't fit, so a type that can't be slid
+	// costs a new block per insert, not a bigger one each time
+	const size_type cap = lastAddr - firstAddr;
+
+	size_type newCap = front + size + n <= cap ? cap : grownCapacity();
+	if(newCap < front + size + n)
+		newCap = front + size + n;
+
+	// unless the allocator can grow this block, then it'll fit after that
+	if(resizable::value && firstAddr)
+	{
+		reallocate(newCap, front);
+		return insertGap(index, n, fill);
+	}
+
+	pointer newFirst = allocateBlock(newCap);
+	pointer newStart = newFirst + front;
+
+	try
+	{
+		fill(newStart + index);
+	}
+	catch(...)
+	{
+		allocator.deallocate(newFirst, newCap);
+		throw;
+	}
+
+	try
+	{
+		relocate(start, index, newStart, relocatable{});
+	}
+	catch(...)
+	{
+		destroy(newStart + index, newStart + index + n);
+		allocator.deallocate(newFirst, newCap);
+		throw;
+	}
+
+	try
+	{
+		relocate(start + index, size - index, newStart + index + n, relocatable{});
+	}
+	catch(...)
+	{
+		// the elements before "index" are already gone from the old block, so all we can keep is the ones after it
+		destroy(newStart, newStart + index + n);
+		allocator.deallocate(newFirst, newCap);
+		start += index;
+		throw;
+	}
+
+	if(firstAddr)
+		allocator.deallocate(firstAddr, lastAddr - firstAddr);
+
+	firstAddr = newFirst;
+	start = newStart;
+	last = newStart + size + n;
+	lastAddr = newFirst + newCap;
+
+	recordMove(true, size * sizeof(value_type));
+
+	return start + index;
+}
+
+// single pass iterators, we can't know how many there are until we've read them all, so collect them first
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insertRange(const_iterator pos, iter first, iter last, std::input_iterator_tag)
+{
+	const size_type index = pos - cbegin();
+
+	// "Alloc" may not be default constructible, so a copy of ours
+	DynArray temp(allocator);
+	for(; first != last; ++first)
+		temp.emplace_back(*first);
+
+	return {insertGap(index, temp.size(), [&temp](pointer to)
+	{
+		relocate(temp.start, temp.size(), to, relocatable{});
+		temp.last = temp.start;
+	})};
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter>
+typename DynArray<T, Alloc, Growth, Observer>::iterator DynArray<T, Alloc, Growth, Observer>::insertRange(const_iterator pos, iter first, iter last, std::forward_iterator_tag)
+{
+	const size_type n = std::distance(first, last);
+
+	return {insertGap(pos - cbegin(), n, [first, n](pointer to)
+	{
+		copyConstruct(first, n, to);
+	})};
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter>
+void DynArray<T, Alloc, Growth, Observer>::assignRange(iter first, iter last, std::input_iterator_tag)
+{
+	clear();
+
+	for(; first != last; ++first)
+		emplace_back(*first);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename iter>
+void DynArray<T, Alloc, Growth, Observer>::assignRange(iter first, iter last, std::forward_iterator_tag)
+{
+	copyFrom(first, std::distance(first, last));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::reserveBack(size_type n)
+{
+	if(n <= static_cast<size_type>(lastAddr - last))
 		return;
 
-	if(start && lastAddr)
-		allocator.deallocate(start, cap);
+	const size_type size = last - start;
+	const size_type front = start - firstAddr;
 
-	start = allocator.allocate(n);
-	last = start;
-	lastAddr = start + sizeof(value_type) * n;
+	size_type newCap = grownCapacity();
+	if(newCap < front + size + n)
+		newCap = front + size + n;
+
+	reallocate(newCap, front);
 }
 
-template<typename T, typename Alloc>
-void DynArray<T, Alloc>::resize(size_type n)
+// nothing to do, they can stay as they are
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::defaultConstruct(pointer, pointer, std::true_type)
+{}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::defaultConstruct(pointer from, pointer to, std::false_type)
 {
-	const auto size = (last - start) / sizeof(value_type);
-	const auto cap = (lastAddr - start) / sizeof(value_type);
+	pointer it = from;
 
-	if(n <= cap)
-		last = start + sizeof(value_type) * n;
+	try
+	{
+		for(; it != to; ++it)
+			new (it) value_type;
+	}
+	catch(...)
+	{
+		destroy(from, it);
+		throw;
+	}
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::closeGap(pointer from, pointer to, std::true_type)
+{
+	const size_type n = to - from;
+	const size_type before = from - start;
+	const size_type after = last - to;
+
+	destroy(from, to);
+
+	// the gap's now raw memory, so the side with fewer elements can just be slid over it
+	if(before < after)
+	{
+		shift(start, before, start + n, std::true_type{});
+		start += n;
+
+		recordMove(false, before * sizeof(value_type));
+		return to;
+	}
 	else
 	{
-		if(start && lastAddr)
-			allocator.deallocate(start, cap);
+		shift(to, after, from, std::true_type{});
+		last -= n;
 
-		start = allocator.allocate(n);
-		last = start + sizeof(value_type) * n;
-		lastAddr = last;
+		recordMove(false, after * sizeof(value_type));
+		return from;
 	}
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::size_type DynArray<T, Alloc>::size()
+// if a move assignment throws, every element is still alive, and none have been removed yet
+template<typename T, typename Alloc, typename Growth, typename Observer>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::closeGap(pointer from, pointer to, std::false_type)
 {
-	return (last - start) / sizeof(value_type);
+	const size_type n = to - from;
+	const size_type before = from - start;
+	const size_type after = last - to;
+
+	if(before < after)
+	{
+		std::move_backward(start, from, to);
+		destroy(start, start + n);
+		start += n;
+
+		recordMove(false, before * sizeof(value_type));
+		return to;
+	}
+	else
+	{
+		std::move(to, last, from);
+		destroy(last - n, last);
+		last -= n;
+
+		recordMove(false, after * sizeof(value_type));
+		return from;
+	}
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename Pred>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::compact(Pred& pred, std::true_type)
+{
+	// kept elements are slid down a run at a time: [run, read) is the run of kept elements not yet moved to "write"
+	pointer write = start;
+	pointer run = start;
+	pointer read = start;
+
+	size_type moved = 0;
+
+	try
+	{
+		for(; read != last; ++read)
+		{
+			if(!pred(*read))
+				continue;
+
+			const size_type keep = read - run;
+
+			if(write != run)
+			{
+				shift(run, keep, write, std::true_type{});
+				moved += keep;
+			}
+
+			write += keep;
+
+			destroy(read, read + 1);
+			run = read + 1;
+		}
+	}
+	catch(...)
+	{
+		// close the holes made so far, keeping everything "pred" didn't get to
+		shift(run, last - run, write, std::true_type{});
+		last = write + (last - run);
+		throw;
+	}
+
+	const size_type keep = last - run;
+
+	if(write != run)
+	{
+		shift(run, keep, write, std::true_type{});
+		moved += keep;
+	}
+
+	if(moved != 0)
+		recordMove(false, moved * sizeof(value_type));
+
+	return write + keep;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::size_type DynArray<T, Alloc>::capacity()
+// if "pred" or a move assignment throws, every element is still alive, but some may have been moved from
+template<typename T, typename Alloc, typename Growth, typename Observer>
+template<typename Pred>
+typename DynArray<T, Alloc, Growth, Observer>::pointer DynArray<T, Alloc, Growth, Observer>::compact(Pred& pred, std::false_type)
 {
-	return (lastAddr - start) / sizeof(value_type);
+	pointer write = start;
+	size_type moved = 0;
+
+	for(pointer read = start; read != last; ++read)
+	{
+		if(pred(*read))
+			continue;
+
+		if(write != read)
+		{
+			*write = std::move(*read);
+			++moved;
+		}
+
+		++write;
+	}
+
+	destroy(write, last);
+
+	if(moved != 0)
+		recordMove(false, moved * sizeof(value_type));
+
+	return write;
 }
 
-template<typename T, typename Alloc>
-typename DynArray<T, Alloc>::size_type DynArray<T, Alloc>::max_size()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::moveOver(pointer from, pointer to, std::true_type)
 {
-	return size_type::max();
+	destroy(to, to + 1);
+	relocate(from, 1, to, std::true_type{});
 }
 
-template<typename T, typename Alloc>
-bool DynArray<T, Alloc>::empty()
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::moveOver(pointer from, pointer to, std::false_type)
 {
-	return start == last;
+	*to = std::move(*from);
+	destroy(from, from + 1);
 }
 
-template<typename T, typename Alloc>
-void swap(DynArray<T, Alloc>&, DynArray<T, Alloc>&)
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::destroy(pointer from, pointer to)
+{
+	destroy(from, to, std::is_trivially_destructible<value_type>{});
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::destroy(pointer, pointer, std::true_type)
 {}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void DynArray<T, Alloc, Growth, Observer>::destroy(pointer from, pointer to, std::false_type)
+{
+	for(; from != to; ++from)
+		from->~value_type();
+}
+
+template<typename T, typename Alloc, typename Growth, typename Observer>
+void swap(DynArray<T, Alloc, Growth, Observer>& lhs, DynArray<T, Alloc, Growth, Observer>& rhs) noexcept(noexcept(lhs.swap(rhs)))
+{
+	lhs.swap(rhs);
+}
+
+#endif
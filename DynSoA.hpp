@@ -0,0 +1,707 @@
+#ifndef DYN_SOA_HPP
+#define DYN_SOA_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "DynArray.hpp"
+#include "Span.hpp"
+
+// a structure of arrays: one DynArray per field, kept the same length
+// a scan over one field only pulls that field through the cache, and each column is a plain array for the compiler to vectorize
+// all of the columns grow together, once the DynSoA decides it's full, rather than each one deciding for itself
+// rows can still be gotten at as a whole, as tuples of references into each column
+template<typename... Ts>
+class DynSoA
+{
+	static_assert(sizeof...(Ts) > 0, "DynSoA needs at least one column");
+
+	public:
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using Row = std::tuple<Ts...>;
+		using Reference = std::tuple<Ts&...>;
+		using ConstReference = std::tuple<const Ts&...>;
+		using Growth = dbr::growth::Double;
+
+		template<std::size_t I>
+		using Column = typename std::tuple_element<I, Row>::type;
+
+		class const_iterator;
+
+		// rows are handed out as tuples of references, so like std::vector<bool>'s, these iterators can't be used
+		// for anything that needs a real reference (like std::sort)
+		class iterator
+		{
+			public:
+				using difference_type = DynSoA::difference_type;
+				using value_type = Row;
+				using reference = Reference;
+				using pointer = void;
+				using iterator_category = std::random_access_iterator_tag;
+
+				iterator();
+				iterator(DynSoA* soa, size_type index);
+
+				bool operator ==(const iterator&) const;
+				bool operator !=(const iterator&) const;
+				bool operator <(const iterator&) const;
+				bool operator >(const iterator&) const;
+				bool operator <=(const iterator&) const;
+				bool operator >=(const iterator&) const;
+
+				iterator& operator ++();	// prefix
+				iterator operator ++(int);	// postfix
+				iterator& operator --();	// prefix
+				iterator operator --(int);	// postfix
+				iterator& operator +=(difference_type);
+				iterator& operator -=(difference_type);
+
+				iterator operator +(difference_type) const;
+				iterator operator -(difference_type) const;
+
+				friend iterator operator +(difference_type lhs, const iterator& rhs)
+				{
+					return rhs + lhs;
+				}
+
+				difference_type operator -(const iterator&) const;
+
+				Reference operator *() const;
+				Reference operator [](difference_type) const;
+
+			private:
+				friend class const_iterator;
+
+				DynSoA* soa;
+				size_type index;
+		};
+
+		class const_iterator
+		{
+			public:
+				using difference_type = DynSoA::difference_type;
+				using value_type = Row;
+				using reference = ConstReference;
+				using pointer = void;
+				using iterator_category = std::random_access_iterator_tag;
+
+				const_iterator();
+				const_iterator(const DynSoA* soa, size_type index);
+				const_iterator(const iterator&);
+
+				bool operator ==(const const_iterator&) const;
+				bool operator !=(const const_iterator&) const;
+				bool operator <(const const_iterator&) const;
+				bool operator >(const const_iterator&) const;
+				bool operator <=(const const_iterator&) const;
+				bool operator >=(const const_iterator&) const;
+
+				const_iterator& operator ++();	// prefix
+				const_iterator operator ++(int);	// postfix
+				const_iterator& operator --();	// prefix
+				const_iterator operator --(int);	// postfix
+				const_iterator& operator +=(difference_type);
+				const_iterator& operator -=(difference_type);
+
+				const_iterator operator +(difference_type) const;
+				const_iterator operator -(difference_type) const;
+
+				friend const_iterator operator +(difference_type lhs, const const_iterator& rhs)
+				{
+					return rhs + lhs;
+				}
+
+				difference_type operator -(const const_iterator&) const;
+
+				ConstReference operator *() const;
+				ConstReference operator [](difference_type) const;
+
+			private:
+				const DynSoA* soa;
+				size_type index;
+		};
+
+		DynSoA();
+
+		// reserving constructor
+		explicit DynSoA(size_type);
+
+		// iterators
+		iterator begin();
+		const_iterator begin() const;
+		const_iterator cbegin() const;
+
+		iterator end();
+		const_iterator end() const;
+		const_iterator cend() const;
+
+		// access
+		Reference operator [](size_type);
+		ConstReference operator [](size_type) const;
+
+		// one column, as a contiguous array
+		template<std::size_t I>
+		dbr::Span<Column<I>> column();
+
+		template<std::size_t I>
+		dbr::Span<const Column<I>> column() const;
+
+		// modifying
+		// one value per column. If constructing one throws, the ones already added to the other columns are taken back out
+		template<typename... Us>
+		void emplace_back(Us&&...);
+
+		void push_back(const Ts&...);
+		void push_back(const Row&);
+
+		void pop_back();
+		void clear();
+
+		// other operations
+		void reserve(size_type);
+
+		// new rows are value-initialized
+		void resize(size_type);
+
+		// queries
+		size_type size() const;
+		size_type capacity() const;
+		bool empty() const;
+
+	private:
+		using Columns = std::tuple<DynArray<Ts>...>;
+		using Indices = std::index_sequence_for<Ts...>;
+
+		template<std::size_t... Is>
+		Reference row(size_type, std::index_sequence<Is...>);
+
+		template<std::size_t... Is>
+		ConstReference row(size_type, std::index_sequence<Is...>) const;
+
+		template<std::size_t... Is>
+		void push_back(const Row&, std::index_sequence<Is...>);
+
+		// adds the Ith value onto the Ith column, and so on for the rest of the columns
+		template<std::size_t I, typename Values>
+		void emplaceColumns(Values&, std::false_type);
+
+		template<std::size_t I, typename Values>
+		void emplaceColumns(Values&, std::true_type);
+
+		// resizes the Ith column to "n" rows, and so on for the rest of the columns
+		// if any of them throws, the ones already resized go back to "old" rows, so every column is still the same size
+		template<std::size_t I>
+		void resizeColumns(size_type n, size_type old, std::false_type);
+
+		template<std::size_t I>
+		void resizeColumns(size_type n, size_type old, std::true_type);
+
+		// calls "fn" on every column
+		template<typename Fn, std::size_t... Is>
+		void eachColumn(Fn fn, std::index_sequence<Is...>);
+
+		// makes sure every column has room for "n" rows
+		void reserveColumns(size_type n);
+
+		Columns columns;
+
+		// rows every column has room for
+		size_type cap;
+};
+
+// iterator
+template<typename... Ts>
+DynSoA<Ts...>::iterator::iterator()
+:	soa(nullptr),
+	index(0)
+{}
+
+template<typename... Ts>
+DynSoA<Ts...>::iterator::iterator(DynSoA* soa, size_type index)
+:	soa(soa),
+	index(index)
+{}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator ==(const iterator& other) const
+{
+	return index == other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator !=(const iterator& other) const
+{
+	return index != other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator <(const iterator& other) const
+{
+	return index < other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator >(const iterator& other) const
+{
+	return index > other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator <=(const iterator& other) const
+{
+	return index <= other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::iterator::operator >=(const iterator& other) const
+{
+	return index >= other.index;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator& DynSoA<Ts...>::iterator::operator ++()
+{
+	++index;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::iterator::operator ++(int)
+{
+	iterator copy = *this;
+	++index;
+	return copy;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator& DynSoA<Ts...>::iterator::operator --()
+{
+	--index;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::iterator::operator --(int)
+{
+	iterator copy = *this;
+	--index;
+	return copy;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator& DynSoA<Ts...>::iterator::operator +=(difference_type n)
+{
+	index += n;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator& DynSoA<Ts...>::iterator::operator -=(difference_type n)
+{
+	index -= n;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::iterator::operator +(difference_type n) const
+{
+	return {soa, index + n};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::iterator::operator -(difference_type n) const
+{
+	return {soa, index - n};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::difference_type DynSoA<Ts...>::iterator::operator -(const iterator& other) const
+{
+	return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::Reference DynSoA<Ts...>::iterator::operator *() const
+{
+	return (*soa)[index];
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::Reference DynSoA<Ts...>::iterator::operator [](difference_type n) const
+{
+	return (*soa)[index + n];
+}
+
+// const_iterator
+template<typename... Ts>
+DynSoA<Ts...>::const_iterator::const_iterator()
+:	soa(nullptr),
+	index(0)
+{}
+
+template<typename... Ts>
+DynSoA<Ts...>::const_iterator::const_iterator(const DynSoA* soa, size_type index)
+:	soa(soa),
+	index(index)
+{}
+
+template<typename... Ts>
+DynSoA<Ts...>::const_iterator::const_iterator(const iterator& other)
+:	soa(other.soa),
+	index(other.index)
+{}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator ==(const const_iterator& other) const
+{
+	return index == other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator !=(const const_iterator& other) const
+{
+	return index != other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator <(const const_iterator& other) const
+{
+	return index < other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator >(const const_iterator& other) const
+{
+	return index > other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator <=(const const_iterator& other) const
+{
+	return index <= other.index;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::const_iterator::operator >=(const const_iterator& other) const
+{
+	return index >= other.index;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator& DynSoA<Ts...>::const_iterator::operator ++()
+{
+	++index;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::const_iterator::operator ++(int)
+{
+	const_iterator copy = *this;
+	++index;
+	return copy;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator& DynSoA<Ts...>::const_iterator::operator --()
+{
+	--index;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::const_iterator::operator --(int)
+{
+	const_iterator copy = *this;
+	--index;
+	return copy;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator& DynSoA<Ts...>::const_iterator::operator +=(difference_type n)
+{
+	index += n;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator& DynSoA<Ts...>::const_iterator::operator -=(difference_type n)
+{
+	index -= n;
+	return *this;
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::const_iterator::operator +(difference_type n) const
+{
+	return {soa, index + n};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::const_iterator::operator -(difference_type n) const
+{
+	return {soa, index - n};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::difference_type DynSoA<Ts...>::const_iterator::operator -(const const_iterator& other) const
+{
+	return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::ConstReference DynSoA<Ts...>::const_iterator::operator *() const
+{
+	return (*soa)[index];
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::ConstReference DynSoA<Ts...>::const_iterator::operator [](difference_type n) const
+{
+	return (*soa)[index + n];
+}
+
+// DynSoA
+template<typename... Ts>
+DynSoA<Ts...>::DynSoA()
+:	DynSoA(Growth::initial(sizeof(Row)))
+{}
+
+template<typename... Ts>
+DynSoA<Ts...>::DynSoA(size_type n)
+	// every column made with room for "n" rows from the start, rather than its own default and then reserved
+:	columns((static_cast<void>(sizeof(Ts)), n)...),
+	cap(n)
+{}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::begin()
+{
+	return {this, 0};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::begin() const
+{
+	return {this, 0};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::cbegin() const
+{
+	return {this, 0};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::iterator DynSoA<Ts...>::end()
+{
+	return {this, size()};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::end() const
+{
+	return {this, size()};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::const_iterator DynSoA<Ts...>::cend() const
+{
+	return {this, size()};
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::Reference DynSoA<Ts...>::operator [](size_type i)
+{
+	return row(i, Indices{});
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::ConstReference DynSoA<Ts...>::operator [](size_type i) const
+{
+	return row(i, Indices{});
+}
+
+template<typename... Ts>
+template<std::size_t I>
+dbr::Span<typename DynSoA<Ts...>::template Column<I>> DynSoA<Ts...>::column()
+{
+	auto& col = std::get<I>(columns);
+	return {col.data(), col.size()};
+}
+
+template<typename... Ts>
+template<std::size_t I>
+dbr::Span<const typename DynSoA<Ts...>::template Column<I>> DynSoA<Ts...>::column() const
+{
+	const auto& col = std::get<I>(columns);
+	return {col.data(), col.size()};
+}
+
+template<typename... Ts>
+template<typename... Us>
+void DynSoA<Ts...>::emplace_back(Us&&... values)
+{
+	static_assert(sizeof...(Us) == sizeof...(Ts), "DynSoA::emplace_back takes one value per column");
+
+	// one decision for all of the columns, so they never each grow on their own
+	if(size() == cap)
+	{
+		size_type grown = Growth::grow(cap, sizeof(Row));
+		if(grown <= cap)
+			grown = cap + 1;
+
+		reserveColumns(grown);
+	}
+
+	auto forwarded = std::forward_as_tuple(std::forward<Us>(values)...);
+	emplaceColumns<0>(forwarded, std::integral_constant<bool, sizeof...(Ts) == 0>{});
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::push_back(const Ts&... values)
+{
+	emplace_back(values...);
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::push_back(const Row& values)
+{
+	push_back(values, Indices{});
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::pop_back()
+{
+	eachColumn([](auto& col) { col.pop_back(); }, Indices{});
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::clear()
+{
+	eachColumn([](auto& col) { col.clear(); }, Indices{});
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::reserve(size_type n)
+{
+	if(n > cap)
+		reserveColumns(n);
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::resize(size_type n)
+{
+	reserve(n);
+	resizeColumns<0>(n, size(), std::integral_constant<bool, sizeof...(Ts) == 0>{});
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::size_type DynSoA<Ts...>::size() const
+{
+	return std::get<0>(columns).size();
+}
+
+template<typename... Ts>
+typename DynSoA<Ts...>::size_type DynSoA<Ts...>::capacity() const
+{
+	return cap;
+}
+
+template<typename... Ts>
+bool DynSoA<Ts...>::empty() const
+{
+	return size() == 0;
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+typename DynSoA<Ts...>::Reference DynSoA<Ts...>::row(size_type i, std::index_sequence<Is...>)
+{
+	return Reference(std::get<Is>(columns)[i]...);
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+typename DynSoA<Ts...>::ConstReference DynSoA<Ts...>::row(size_type i, std::index_sequence<Is...>) const
+{
+	return ConstReference(std::get<Is>(columns)[i]...);
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+void DynSoA<Ts...>::push_back(const Row& values, std::index_sequence<Is...>)
+{
+	emplace_back(std::get<Is>(values)...);
+}
+
+template<typename... Ts>
+template<std::size_t I, typename Values>
+void DynSoA<Ts...>::emplaceColumns(Values& values, std::false_type)
+{
+	using Value = typename std::tuple_element<I, Values>::type;
+
+	auto& col = std::get<I>(columns);
+	col.emplace_back(std::forward<Value>(std::get<I>(values)));
+
+	try
+	{
+		emplaceColumns<I + 1>(values, std::integral_constant<bool, I + 1 == sizeof...(Ts)>{});
+	}
+	catch(...)
+	{
+		col.pop_back();
+		throw;
+	}
+}
+
+template<typename... Ts>
+template<std::size_t I, typename Values>
+void DynSoA<Ts...>::emplaceColumns(Values&, std::true_type)
+{}
+
+template<typename... Ts>
+template<std::size_t I>
+void DynSoA<Ts...>::resizeColumns(size_type n, size_type old, std::false_type)
+{
+	auto& col = std::get<I>(columns);
+
+	// a column that throws partway through resizing is put back too
+	try
+	{
+		col.resize(n);
+		resizeColumns<I + 1>(n, old, std::integral_constant<bool, I + 1 == sizeof...(Ts)>{});
+	}
+	catch(...)
+	{
+		col.resize(old);
+		throw;
+	}
+}
+
+template<typename... Ts>
+template<std::size_t I>
+void DynSoA<Ts...>::resizeColumns(size_type, size_type, std::true_type)
+{}
+
+template<typename... Ts>
+template<typename Fn, std::size_t... Is>
+void DynSoA<Ts...>::eachColumn(Fn fn, std::index_sequence<Is...>)
+{
+	// expands to fn(column 0), fn(column 1), ..., in order
+	int expand[] = {(fn(std::get<Is>(columns)), 0)...};
+	(void)expand;
+}
+
+template<typename... Ts>
+void DynSoA<Ts...>::reserveColumns(size_type n)
+{
+	eachColumn([n](auto& col) { col.reserve(n); }, Indices{});
+	cap = n;
+}
+
+#endif
@@ -0,0 +1,522 @@
+#ifndef FLAT_MAP_HPP
+#define FLAT_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "DynArray.hpp"
+#include "Span.hpp"
+
+// sorted associative containers over contiguous DynArrays, for lookup tables that are read far more than written
+// a lookup is a binary search over one array of keys, rather than a pointer chase through tree nodes
+// inserting and erasing shift everything after them (O(n)), so big tables should be built in bulk,
+// which sorts everything once
+namespace dbr
+{
+	namespace impl
+	{
+		// index of the first key not less than "key" (std::lower_bound), without a branch on the comparison
+		// each step halves the range with a conditional move instead, so mispredictions don't stall it
+		template<typename Key, typename Compare>
+		std::size_t branchlessLowerBound(const Key* keys, std::size_t n, const Key& key, const Compare& comp)
+		{
+			if(n == 0)
+				return 0;
+
+			const Key* base = keys;
+
+			while(n > 1)
+			{
+				const std::size_t half = n / 2;
+				base = comp(base[half], key) ? base + half : base;
+				n -= half;
+			}
+
+			return (base - keys) + comp(*base, key);
+		}
+
+		// sorts "items" by "key(item)" and drops all but the first of any equal keys
+		template<typename Item, typename KeyOf, typename Compare>
+		void sortUnique(DynArray<Item>& items, KeyOf key, const Compare& comp)
+		{
+			Item* first = items.data();
+			Item* last = first + items.size();
+
+			std::stable_sort(first, last, [&](const Item& lhs, const Item& rhs) { return comp(key(lhs), key(rhs)); });
+
+			Item* end = std::unique(first, last, [&](const Item& lhs, const Item& rhs) { return !comp(key(lhs), key(rhs)); });
+
+			while(items.size() > static_cast<std::size_t>(end - first))
+				items.pop_back();
+		}
+	}
+}
+
+template<typename Key, typename Value, typename Compare = std::less<Key>>
+class FlatMap
+{
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using size_type = std::size_t;
+
+		FlatMap();
+		explicit FlatMap(const Compare&);
+
+		// bulk building, sorted once. For equal keys, the first one wins
+		template<typename iter>
+		FlatMap(iter first, iter last, const Compare& = Compare{});
+		FlatMap(std::initializer_list<std::pair<Key, Value>>, const Compare& = Compare{});
+
+		template<typename iter>
+		void assign(iter first, iter last);
+
+		// lookup
+		// nullptr if there's no such key
+		Value* find(const Key&);
+		const Value* find(const Key&) const;
+
+		bool contains(const Key&) const;
+		size_type count(const Key&) const;
+
+		// throws std::out_of_range if there's no such key
+		Value& at(const Key&);
+		const Value& at(const Key&) const;
+
+		// inserts a value-initialized Value if there's no such key
+		Value& operator [](const Key&);
+
+		// modifying
+		// returns false (and leaves the old value) if the key was already there
+		template<typename... Args>
+		bool emplace(const Key&, Args&&...);
+
+		bool insert(const Key&, const Value&);
+
+		// inserts or replaces
+		void insert_or_assign(const Key&, const Value&);
+
+		// returns false if there was no such key
+		bool erase(const Key&);
+
+		void clear();
+		void reserve(size_type);
+
+		// the keys in order, and their values in the same order
+		dbr::Span<const Key> keys() const;
+		dbr::Span<Value> values();
+		dbr::Span<const Value> values() const;
+
+		size_type size() const;
+		bool empty() const;
+
+	private:
+		// where "key" is, or would be
+		size_type lowerBound(const Key&) const;
+		bool foundAt(size_type, const Key&) const;
+
+		DynArray<Key> keyArr;
+		DynArray<Value> valueArr;
+
+		Compare comp;
+};
+
+template<typename Key, typename Compare = std::less<Key>>
+class FlatSet
+{
+	public:
+		using key_type = Key;
+		using value_type = Key;
+		using size_type = std::size_t;
+		using const_iterator = const Key*;
+
+		FlatSet();
+		explicit FlatSet(const Compare&);
+
+		// bulk building, sorted once
+		template<typename iter>
+		FlatSet(iter first, iter last, const Compare& = Compare{});
+		FlatSet(std::initializer_list<Key>, const Compare& = Compare{});
+
+		template<typename iter>
+		void assign(iter first, iter last);
+
+		bool contains(const Key&) const;
+		size_type count(const Key&) const;
+
+		// the first key not less than the one given, or end()
+		const_iterator lower_bound(const Key&) const;
+
+		// returns false if the key was already there
+		bool insert(const Key&);
+
+		// returns false if there was no such key
+		bool erase(const Key&);
+
+		void clear();
+		void reserve(size_type);
+
+		// in order
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		size_type size() const;
+		bool empty() const;
+
+	private:
+		size_type lowerBoundIndex(const Key&) const;
+
+		DynArray<Key> keyArr;
+
+		Compare comp;
+};
+
+// FlatMap
+template<typename Key, typename Value, typename Compare>
+FlatMap<Key, Value, Compare>::FlatMap()
+:	FlatMap(Compare{})
+{}
+
+template<typename Key, typename Value, typename Compare>
+FlatMap<Key, Value, Compare>::FlatMap(const Compare& comp)
+:	comp(comp)
+{}
+
+template<typename Key, typename Value, typename Compare>
+template<typename iter>
+FlatMap<Key, Value, Compare>::FlatMap(iter first, iter last, const Compare& comp)
+:	comp(comp)
+{
+	assign(first, last);
+}
+
+template<typename Key, typename Value, typename Compare>
+FlatMap<Key, Value, Compare>::FlatMap(std::initializer_list<std::pair<Key, Value>> list, const Compare& comp)
+:	comp(comp)
+{
+	assign(list.begin(), list.end());
+}
+
+template<typename Key, typename Value, typename Compare>
+template<typename iter>
+void FlatMap<Key, Value, Compare>::assign(iter first, iter last)
+{
+	DynArray<std::pair<Key, Value>> items;
+	for(; first != last; ++first)
+		items.push_back(*first);
+
+	dbr::impl::sortUnique(items, [](const std::pair<Key, Value>& item) -> const Key& { return item.first; }, comp);
+
+	DynArray<Key> newKeys(items.size());
+	DynArray<Value> newValues(items.size());
+
+	for(size_type i = 0; i < items.size(); ++i)
+	{
+		newKeys.push_back(std::move(items[i].first));
+		newValues.push_back(std::move(items[i].second));
+	}
+
+	keyArr = std::move(newKeys);
+	valueArr = std::move(newValues);
+}
+
+template<typename Key, typename Value, typename Compare>
+Value* FlatMap<Key, Value, Compare>::find(const Key& key)
+{
+	const size_type i = lowerBound(key);
+	return foundAt(i, key) ? &valueArr[i] : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare>
+const Value* FlatMap<Key, Value, Compare>::find(const Key& key) const
+{
+	const size_type i = lowerBound(key);
+	return foundAt(i, key) ? &valueArr[i] : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::contains(const Key& key) const
+{
+	return foundAt(lowerBound(key), key);
+}
+
+template<typename Key, typename Value, typename Compare>
+typename FlatMap<Key, Value, Compare>::size_type FlatMap<Key, Value, Compare>::count(const Key& key) const
+{
+	return contains(key) ? 1 : 0;
+}
+
+template<typename Key, typename Value, typename Compare>
+Value& FlatMap<Key, Value, Compare>::at(const Key& key)
+{
+	Value* value = find(key);
+	if(!value)
+		throw std::out_of_range("FlatMap::at");
+
+	return *value;
+}
+
+template<typename Key, typename Value, typename Compare>
+const Value& FlatMap<Key, Value, Compare>::at(const Key& key) const
+{
+	const Value* value = find(key);
+	if(!value)
+		throw std::out_of_range("FlatMap::at");
+
+	return *value;
+}
+
+template<typename Key, typename Value, typename Compare>
+Value& FlatMap<Key, Value, Compare>::operator [](const Key& key)
+{
+	const size_type i = lowerBound(key);
+
+	if(!foundAt(i, key))
+		emplace(key, Value());
+
+	return valueArr[i];
+}
+
+template<typename Key, typename Value, typename Compare>
+template<typename... Args>
+bool FlatMap<Key, Value, Compare>::emplace(const Key& key, Args&&... args)
+{
+	const size_type i = lowerBound(key);
+
+	if(foundAt(i, key))
+		return false;
+
+	valueArr.emplace(valueArr.cbegin() + i, std::forward<Args>(args)...);
+
+	// keep the two in step if the key can't go in
+	try
+	{
+		keyArr.insert(keyArr.cbegin() + i, key);
+	}
+	catch(...)
+	{
+		valueArr.erase(valueArr.cbegin() + i);
+		throw;
+	}
+
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::insert(const Key& key, const Value& value)
+{
+	return emplace(key, value);
+}
+
+template<typename Key, typename Value, typename Compare>
+void FlatMap<Key, Value, Compare>::insert_or_assign(const Key& key, const Value& value)
+{
+	const size_type i = lowerBound(key);
+
+	if(foundAt(i, key))
+		valueArr[i] = value;
+	else
+		emplace(key, value);
+}
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::erase(const Key& key)
+{
+	const size_type i = lowerBound(key);
+
+	if(!foundAt(i, key))
+		return false;
+
+	keyArr.erase(keyArr.cbegin() + i);
+	valueArr.erase(valueArr.cbegin() + i);
+
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare>
+void FlatMap<Key, Value, Compare>::clear()
+{
+	keyArr.clear();
+	valueArr.clear();
+}
+
+template<typename Key, typename Value, typename Compare>
+void FlatMap<Key, Value, Compare>::reserve(size_type n)
+{
+	keyArr.reserve(n);
+	valueArr.reserve(n);
+}
+
+template<typename Key, typename Value, typename Compare>
+dbr::Span<const Key> FlatMap<Key, Value, Compare>::keys() const
+{
+	return {keyArr.data(), keyArr.size()};
+}
+
+template<typename Key, typename Value, typename Compare>
+dbr::Span<Value> FlatMap<Key, Value, Compare>::values()
+{
+	return {valueArr.data(), valueArr.size()};
+}
+
+template<typename Key, typename Value, typename Compare>
+dbr::Span<const Value> FlatMap<Key, Value, Compare>::values() const
+{
+	return {valueArr.data(), valueArr.size()};
+}
+
+template<typename Key, typename Value, typename Compare>
+typename FlatMap<Key, Value, Compare>::size_type FlatMap<Key, Value, Compare>::size() const
+{
+	return keyArr.size();
+}
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::empty() const
+{
+	return keyArr.empty();
+}
+
+template<typename Key, typename Value, typename Compare>
+typename FlatMap<Key, Value, Compare>::size_type FlatMap<Key, Value, Compare>::lowerBound(const Key& key) const
+{
+	return dbr::impl::branchlessLowerBound(keyArr.data(), keyArr.size(), key, comp);
+}
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::foundAt(size_type i, const Key& key) const
+{
+	return i < keyArr.size() && !comp(key, keyArr[i]);
+}
+
+// FlatSet
+template<typename Key, typename Compare>
+FlatSet<Key, Compare>::FlatSet()
+:	FlatSet(Compare{})
+{}
+
+template<typename Key, typename Compare>
+FlatSet<Key, Compare>::FlatSet(const Compare& comp)
+:	comp(comp)
+{}
+
+template<typename Key, typename Compare>
+template<typename iter>
+FlatSet<Key, Compare>::FlatSet(iter first, iter last, const Compare& comp)
+:	comp(comp)
+{
+	assign(first, last);
+}
+
+template<typename Key, typename Compare>
+FlatSet<Key, Compare>::FlatSet(std::initializer_list<Key> list, const Compare& comp)
+:	comp(comp)
+{
+	assign(list.begin(), list.end());
+}
+
+template<typename Key, typename Compare>
+template<typename iter>
+void FlatSet<Key, Compare>::assign(iter first, iter last)
+{
+	DynArray<Key> items;
+	for(; first != last; ++first)
+		items.push_back(*first);
+
+	dbr::impl::sortUnique(items, [](const Key& key) -> const Key& { return key; }, comp);
+
+	keyArr = std::move(items);
+}
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::contains(const Key& key) const
+{
+	const size_type i = lowerBoundIndex(key);
+	return i < keyArr.size() && !comp(key, keyArr[i]);
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::size_type FlatSet<Key, Compare>::count(const Key& key) const
+{
+	return contains(key) ? 1 : 0;
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::const_iterator FlatSet<Key, Compare>::lower_bound(const Key& key) const
+{
+	return begin() + lowerBoundIndex(key);
+}
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::insert(const Key& key)
+{
+	const size_type i = lowerBoundIndex(key);
+
+	if(i < keyArr.size() && !comp(key, keyArr[i]))
+		return false;
+
+	keyArr.insert(keyArr.cbegin() + i, key);
+	return true;
+}
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::erase(const Key& key)
+{
+	const size_type i = lowerBoundIndex(key);
+
+	if(i == keyArr.size() || comp(key, keyArr[i]))
+		return false;
+
+	keyArr.erase(keyArr.cbegin() + i);
+
+	return true;
+}
+
+template<typename Key, typename Compare>
+void FlatSet<Key, Compare>::clear()
+{
+	keyArr.clear();
+}
+
+template<typename Key, typename Compare>
+void FlatSet<Key, Compare>::reserve(size_type n)
+{
+	keyArr.reserve(n);
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::const_iterator FlatSet<Key, Compare>::begin() const
+{
+	return keyArr.data();
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::const_iterator FlatSet<Key, Compare>::end() const
+{
+	return keyArr.data() + keyArr.size();
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::size_type FlatSet<Key, Compare>::size() const
+{
+	return keyArr.size();
+}
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::empty() const
+{
+	return keyArr.empty();
+}
+
+template<typename Key, typename Compare>
+typename FlatSet<Key, Compare>::size_type FlatSet<Key, Compare>::lowerBoundIndex(const Key& key) const
+{
+	return dbr::impl::branchlessLowerBound(keyArr.data(), keyArr.size(), key, comp);
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 
 namespace dbr
 {
@@ -10,26 +11,31 @@ namespace dbr
 	{
 		// "bytes" is a byte pointer to the data
 		// "length" is the number of contiguous bytes pointed to by "bytes"
-		std::uint32_t fletcher32(const std::uint8_t* bytes, std::size_t length)
+		inline std::uint32_t fletcher32(const std::uint8_t* bytes, std::size_t length)
 		{
 			// 0xffff is the max 16 bit number
 			std::uint32_t sum0 = 0xffff;
 			std::uint32_t sum1 = 0xffff;
 	
 			// divide by 2 because we are looking at 2 bytes at a time
-			std::uint32_t bytesLeft = length / 2;
-			const std::uint16_t* dataPtr = reinterpret_cast<const std::uint16_t*>(bytes);
+			std::size_t bytesLeft = length / 2;
+			const std::uint8_t* dataPtr = bytes;
 	
 			while(bytesLeft)
 			{
 				// limit bytes processed at a time to prevent overflow. 359 is the max number of additions,
 				// but 0x100 is a nice 2^8
-				std::uint32_t len = bytesLeft > 0x100 ? 0x100 : bytesLeft;
+				std::size_t len = bytesLeft > 0x100 ? 0x100 : bytesLeft;
 				bytesLeft -= len;
 	
 				do
 				{
-					sum1 += sum0 += *dataPtr++;
+					// memcpy, since "bytes" doesn't have to be 2 byte aligned
+					std::uint16_t word;
+					std::memcpy(&word, dataPtr, sizeof(word));
+					dataPtr += sizeof(word);
+	
+					sum1 += sum0 += word;
 				}
 				while(--len);
 	
@@ -37,6 +43,15 @@ namespace dbr
 				sum1 = (sum1 & 0xffff) + (sum1 >> 0x10);
 			}
 	
+			// an odd byte at the end counts as if it were padded with a 0
+			if(length & 1)
+			{
+				sum1 += sum0 += bytes[length - 1];
+	
+				sum0 = (sum0 & 0xffff) + (sum0 >> 0x10);
+				sum1 = (sum1 & 0xffff) + (sum1 >> 0x10);
+			}
+	
 			sum0 = (sum0 & 0xffff) + (sum0 >> 0x10);
 			sum1 = (sum1 & 0xffff) + (sum1 >> 0x10);
 	
@@ -45,7 +60,7 @@ namespace dbr
 	
 		// "bytes" is a byte pointer to the data
 		// "length" is the number of contiguous bytes pointed to by "bytes"
-		std::size_t fnv1a(const std::uint8_t* bytes, std::size_t length)
+		inline std::size_t fnv1a(const std::uint8_t* bytes, std::size_t length)
 		{
 			// FNV-1a hash (values for "prime" and "offset" from: http://isthe.com/chongo/tech/comp/fnv/#FNV-param)
 			// (2 power of x) == 2 << (x - 1)
@@ -53,7 +68,7 @@ namespace dbr
 // using architecture detection from nothings' stb libraries (www.github.com/nothings/stb)
 #if defined(__x86_64__) || defined(_M_X64)
 		// 64 bit
-		constexpr std::size_t prime = (2u << 39) + (2u << 7) + 0xb3u;
+		constexpr std::size_t prime = (std::size_t(2) << 39) + (2u << 7) + 0xb3u;
 		constexpr std::size_t offset = 14695981039346656037u;
 #elif defined(__i386) || defined(_M_IX86)
 		// 32 bit
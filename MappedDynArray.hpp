@@ -0,0 +1,506 @@
+#ifndef MAPPED_DYN_ARRAY_HPP
+#define MAPPED_DYN_ARRAY_HPP
+
+#ifndef __linux__
+#	error "MappedDynArray grows its mapping with mremap(), which is Linux only"
+#endif
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "DynArray.hpp"
+
+// an allocator that hands out memory mapped blocks, which DynArray grows in place through reallocate() (mremap)
+// bound to a file, the block *is* the file: allocating maps all of it (growing the file to fit if needed),
+// and growing the block grows the file. So a file can only back one block at a time
+// without a file, blocks are anonymous mappings, which still grow without anything being copied
+template<typename T>
+class MappedFileAllocator
+{
+	public:
+		using value_type = T;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using difference_type = std::ptrdiff_t;
+		using size_type = std::size_t;
+
+		struct allocation_result
+		{
+			pointer ptr;
+			size_type count;
+		};
+
+		template<typename U>
+		struct rebind
+		{
+			using other = MappedFileAllocator<U>;
+		};
+
+		// an array keeps its allocator when another one is moved into it
+		// so a file's array stays in its file, and the other's elements are moved into it
+		using propagate_on_container_move_assignment = std::false_type;
+
+		// anonymous mappings
+		MappedFileAllocator();
+
+		// mappings of the file open as "fd", which is left open when we're done with it
+		MappedFileAllocator(int fd, bool readOnly);
+
+		// copies use the same file, but not the block mapped from it
+		MappedFileAllocator(const MappedFileAllocator&);
+		MappedFileAllocator(MappedFileAllocator&&);
+
+		MappedFileAllocator& operator =(const MappedFileAllocator&) = delete;
+		MappedFileAllocator& operator =(MappedFileAllocator&&);
+
+		~MappedFileAllocator() = default;
+
+		// what a copy of a container gets: an anonymous allocator
+		// so a copy of a file's array is a private copy of its elements, rather than a second mapping of the file
+		MappedFileAllocator select_on_container_copy_construction() const;
+
+		pointer allocate(size_type n);
+		allocation_result allocate_at_least(size_type n);
+		pointer reallocate(pointer ptr, size_type oldCount, size_type newCount);
+		void deallocate(pointer ptr, size_type n);
+
+		bool readOnly() const;
+
+		// any block can be unmapped from anywhere, but a file's block is tracked by whoever has it
+		template<typename U>
+		friend bool operator ==(const MappedFileAllocator<U>&, const MappedFileAllocator<U>&);
+
+		template<typename U>
+		friend bool operator !=(const MappedFileAllocator<U>&, const MappedFileAllocator<U>&);
+
+	private:
+		static std::size_t pageRound(std::size_t bytes);
+
+		int fd;
+		bool readOnlyMap;
+
+		// the block mapped from the file, if any, and how many bytes of the file it covers
+		pointer mapped;
+		std::size_t mappedBytes;
+};
+
+// a DynArray living in a file, for datasets bigger than memory
+// opening one is a single mmap (nothing is read or copied up front), the file grows along with the array,
+// and any number of processes can open the same file read only and share its pages
+// the file is nothing but the elements back to back, so only trivially copyable types make sense
+// while open, the file may have unused capacity at the end (and headroom at the front, after a push_front)
+// it's trimmed down to exactly the elements by sync(), and when it's closed
+// so other processes opening it see the elements as of the last sync (if the writer crashes, the spare room stays)
+template<typename T, typename Growth = dbr::growth::PageRounded<>>
+class MappedDynArray
+{
+	static_assert(std::is_trivially_copyable<T>::value, "MappedDynArray can only store trivially copyable types");
+
+	public:
+		using Array = DynArray<T, MappedFileAllocator<T>, Growth>;
+
+		enum class Mode
+		{
+			ReadOnly,
+			ReadWrite,
+		};
+
+		// opens (or in ReadWrite mode, creates) the file at "path"
+		MappedDynArray(const std::string& path, Mode mode = Mode::ReadWrite);
+
+		MappedDynArray(const MappedDynArray&) = delete;
+		MappedDynArray& operator =(const MappedDynArray&) = delete;
+
+		~MappedDynArray();
+
+		// not for ReadOnly arrays, their pages can't be written to (so it's easiest to make those const)
+		Array& array();
+		const Array& array() const;
+
+		// trims the file down to exactly the elements, and writes them out to it now,
+		// rather than whenever the kernel gets to them. The next push grows it again
+		void sync();
+
+		Mode mode() const;
+
+	private:
+		// owns a file descriptor, and closes it when it goes
+		// so whichever step of construction throws, the file opened for it isn't leaked
+		class File
+		{
+			public:
+				explicit File(int fd);
+				File(File&&);
+
+				File(const File&) = delete;
+				File& operator =(const File&) = delete;
+
+				~File();
+
+				int get() const;
+
+			private:
+				int fd;
+		};
+
+		MappedDynArray(File file, Mode mode);
+
+		// "count" is how many elements the file had, before mapping it grew it
+		MappedDynArray(File& file, std::size_t count, Mode mode);
+
+		static int openFile(const std::string& path, Mode mode);
+		static std::size_t fileElements(int fd);
+
+		// before the elements, so it's still open while they're unmapped
+		File file;
+		Mode openMode;
+
+		Array elements;
+};
+
+// MappedFileAllocator
+template<typename T>
+MappedFileAllocator<T>::MappedFileAllocator()
+:	fd(-1),
+	readOnlyMap(false),
+	mapped(nullptr),
+	mappedBytes(0)
+{}
+
+template<typename T>
+MappedFileAllocator<T>::MappedFileAllocator(int fd, bool readOnly)
+:	fd(fd),
+	readOnlyMap(readOnly),
+	mapped(nullptr),
+	mappedBytes(0)
+{}
+
+template<typename T>
+MappedFileAllocator<T>::MappedFileAllocator(const MappedFileAllocator& other)
+:	fd(other.fd),
+	readOnlyMap(other.readOnlyMap),
+	mapped(nullptr),
+	mappedBytes(0)
+{}
+
+template<typename T>
+MappedFileAllocator<T>::MappedFileAllocator(MappedFileAllocator&& other)
+:	fd(other.fd),
+	readOnlyMap(other.readOnlyMap),
+	mapped(other.mapped),
+	mappedBytes(other.mappedBytes)
+{
+	other.mapped = nullptr;
+	other.mappedBytes = 0;
+}
+
+template<typename T>
+MappedFileAllocator<T>& MappedFileAllocator<T>::operator =(MappedFileAllocator&& other)
+{
+	fd = other.fd;
+	readOnlyMap = other.readOnlyMap;
+	mapped = other.mapped;
+	mappedBytes = other.mappedBytes;
+
+	other.mapped = nullptr;
+	other.mappedBytes = 0;
+
+	return *this;
+}
+
+template<typename T>
+MappedFileAllocator<T> MappedFileAllocator<T>::select_on_container_copy_construction() const
+{
+	return {};
+}
+
+template<typename T>
+typename MappedFileAllocator<T>::pointer MappedFileAllocator<T>::allocate(size_type n)
+{
+	return allocate_at_least(n).ptr;
+}
+
+template<typename T>
+typename MappedFileAllocator<T>::allocation_result MappedFileAllocator<T>::allocate_at_least(size_type n)
+{
+	// anonymous, the rest of the last page is ours too
+	if(fd < 0)
+	{
+		const std::size_t bytes = pageRound(n * sizeof(T));
+
+		void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(mem == MAP_FAILED)
+			throw std::bad_alloc();
+
+		return {static_cast<pointer>(mem), bytes / sizeof(T)};
+	}
+
+	if(mapped)
+		throw std::logic_error("MappedFileAllocator: the file is already mapped");
+
+	struct stat info;
+	if(fstat(fd, &info) != 0)
+		throw std::system_error(errno, std::generic_category(), "MappedFileAllocator: fstat");
+
+	// the block is at least the whole file, so whatever's in it already can be adopted
+	std::size_t bytes = info.st_size;
+
+	if(!readOnlyMap && bytes < n * sizeof(T))
+	{
+		bytes = pageRound(n * sizeof(T));
+
+		if(ftruncate(fd, bytes) != 0)
+			throw std::system_error(errno, std::generic_category(), "MappedFileAllocator: ftruncate");
+	}
+
+	// can't map nothing (an empty file opened read only)
+	if(bytes == 0)
+		return {nullptr, 0};
+
+	const int prot = readOnlyMap ? PROT_READ : PROT_READ | PROT_WRITE;
+
+	void* mem = mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+	if(mem == MAP_FAILED)
+		throw std::system_error(errno, std::generic_category(), "MappedFileAllocator: mmap");
+
+	mapped = static_cast<pointer>(mem);
+	mappedBytes = bytes;
+
+	return {mapped, bytes / sizeof(T)};
+}
+
+template<typename T>
+typename MappedFileAllocator<T>::pointer MappedFileAllocator<T>::reallocate(pointer ptr, size_type oldCount, size_type newCount)
+{
+	const bool fromFile = ptr && ptr == mapped;
+
+	if(fromFile && readOnlyMap)
+		throw std::logic_error("MappedFileAllocator: can't grow a read only mapping");
+
+	const std::size_t oldBytes = fromFile ? mappedBytes : pageRound(oldCount * sizeof(T));
+	const std::size_t newBytes = pageRound(newCount * sizeof(T));
+
+	// the file has to be big enough before more of it is mapped
+	// it's exactly the block, rather than whole pages, so a block shrunk down to its elements is a file of just them
+	if(fromFile && ftruncate(fd, newCount * sizeof(T)) != 0)
+		throw std::system_error(errno, std::generic_category(), "MappedFileAllocator: ftruncate");
+
+	void* mem = mremap(ptr, oldBytes, newBytes, MREMAP_MAYMOVE);
+	if(mem == MAP_FAILED)
+	{
+		if(fromFile)
+			throw std::system_error(errno, std::generic_category(), "MappedFileAllocator: mremap");
+
+		throw std::bad_alloc();
+	}
+
+	if(fromFile)
+	{
+		mapped = static_cast<pointer>(mem);
+		mappedBytes = newBytes;
+	}
+
+	return static_cast<pointer>(mem);
+}
+
+template<typename T>
+void MappedFileAllocator<T>::deallocate(pointer ptr, size_type n)
+{
+	if(ptr == mapped)
+	{
+		munmap(ptr, mappedBytes);
+
+		mapped = nullptr;
+		mappedBytes = 0;
+	}
+	else
+	{
+		munmap(ptr, pageRound(n * sizeof(T)));
+	}
+}
+
+template<typename T>
+bool MappedFileAllocator<T>::readOnly() const
+{
+	return readOnlyMap;
+}
+
+template<typename T>
+std::size_t MappedFileAllocator<T>::pageRound(std::size_t bytes)
+{
+	static const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+
+	if(bytes == 0)
+		bytes = 1;
+
+	return (bytes + pageSize - 1) / pageSize * pageSize;
+}
+
+template<typename T>
+bool operator ==(const MappedFileAllocator<T>& lhs, const MappedFileAllocator<T>& rhs)
+{
+	return lhs.fd == rhs.fd;
+}
+
+template<typename T>
+bool operator !=(const MappedFileAllocator<T>& lhs, const MappedFileAllocator<T>& rhs)
+{
+	return !(lhs == rhs);
+}
+
+// MappedDynArray::File
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::File::File(int fd)
+:	fd(fd)
+{}
+
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::File::File(File&& other)
+:	fd(other.fd)
+{
+	other.fd = -1;
+}
+
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::File::~File()
+{
+	if(fd >= 0)
+		close(fd);
+}
+
+template<typename T, typename Growth>
+int MappedDynArray<T, Growth>::File::get() const
+{
+	return fd;
+}
+
+// MappedDynArray
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::MappedDynArray(const std::string& path, Mode mode)
+:	MappedDynArray(File(openFile(path, mode)), mode)
+{}
+
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::MappedDynArray(File file, Mode mode)
+:	MappedDynArray(file, fileElements(file.get()), mode)
+{}
+
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::MappedDynArray(File& file, std::size_t count, Mode mode)
+:	file(std::move(file)),
+	openMode(mode),
+	elements(MappedFileAllocator<T>(this->file.get(), mode == Mode::ReadOnly))
+{
+	// the block is the whole file, so the elements already in it just need to be counted in
+	elements.commit(count);
+}
+
+template<typename T, typename Growth>
+MappedDynArray<T, Growth>::~MappedDynArray()
+{
+	if(openMode == Mode::ReadWrite)
+	{
+		const std::size_t size = elements.size();
+
+		// the file starts at the block, so any headroom has to go before the spare room can be cut off
+		if(elements.frontCapacity())
+		{
+			T* data = elements.data();
+			std::memmove(data - elements.frontCapacity(), data, size * sizeof(T));
+		}
+
+		// nothing touches the block past the elements from here on, only unmaps it
+		if(ftruncate(file.get(), size * sizeof(T)) != 0)
+		{
+			// nothing sensible to do about it in a destructor, the file just keeps its spare room
+		}
+	}
+}
+
+template<typename T, typename Growth>
+typename MappedDynArray<T, Growth>::Array& MappedDynArray<T, Growth>::array()
+{
+	if(openMode == Mode::ReadOnly)
+		throw std::logic_error("MappedDynArray: can't modify a read only array");
+
+	return elements;
+}
+
+template<typename T, typename Growth>
+const typename MappedDynArray<T, Growth>::Array& MappedDynArray<T, Growth>::array() const
+{
+	return elements;
+}
+
+template<typename T, typename Growth>
+void MappedDynArray<T, Growth>::sync()
+{
+	if(openMode == Mode::ReadOnly)
+		return;
+
+	// the block is exactly the elements after this, and so is the file (reallocate() sizes it to match)
+	// an empty array has no block, so that file is cut down here
+	elements.shrink_to_fit();
+
+	if(elements.empty())
+	{
+		if(ftruncate(file.get(), 0) != 0)
+			throw std::system_error(errno, std::generic_category(), "MappedDynArray: ftruncate");
+
+		return;
+	}
+
+	// msync needs a page aligned address, which the block is, but the first element may not be
+	const T* data = elements.data();
+	const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+
+	const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data) / pageSize * pageSize;
+	const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(data + elements.size());
+
+	if(msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC) != 0)
+		throw std::system_error(errno, std::generic_category(), "MappedDynArray: msync");
+}
+
+template<typename T, typename Growth>
+typename MappedDynArray<T, Growth>::Mode MappedDynArray<T, Growth>::mode() const
+{
+	return openMode;
+}
+
+template<typename T, typename Growth>
+int MappedDynArray<T, Growth>::openFile(const std::string& path, Mode mode)
+{
+	const int fd = mode == Mode::ReadOnly ? open(path.c_str(), O_RDONLY) : open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+	if(fd < 0)
+		throw std::system_error(errno, std::generic_category(), "MappedDynArray: " + path);
+
+	return fd;
+}
+
+template<typename T, typename Growth>
+std::size_t MappedDynArray<T, Growth>::fileElements(int fd)
+{
+	struct stat info;
+	if(fstat(fd, &info) != 0)
+		throw std::system_error(errno, std::generic_category(), "MappedDynArray: fstat");
+
+	return info.st_size / sizeof(T);
+}
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef PACKED_DYN_ARRAY_HPP
+#define PACKED_DYN_ARRAY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "BitOps.hpp"
+#include "DynArray.hpp"
+
+namespace dbr
+{
+	namespace impl
+	{
+		// the smallest unsigned type that can hold "Bits" bits
+		template<std::size_t Bits>
+		struct PackedValue
+		{
+			using type = typename std::conditional<Bits <= 8, std::uint8_t,
+			             typename std::conditional<Bits <= 16, std::uint16_t,
+			             typename std::conditional<Bits <= 32, std::uint32_t, std::uint64_t>::type>::type>::type;
+		};
+	}
+}
+
+// an array of unsigned integers Bits wide each, packed end to end into 64 bit words
+// for large arrays of small values (flags, small IDs) where scanning a whole T per element wastes memory bandwidth
+// elements can straddle two words. There's always one spare word at the end, so reading or writing one
+// never has to check whether its high part exists
+// elements are values, not objects, so there are no references to them: get() and set() instead
+template<std::size_t Bits, typename T = typename dbr::impl::PackedValue<Bits>::type>
+class PackedDynArray
+{
+	static_assert(Bits > 0 && Bits <= 64, "PackedDynArray elements have to be 1 to 64 bits wide");
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using word_type = std::uint64_t;
+
+		static constexpr std::size_t bitsPerWord = 64;
+		static constexpr word_type mask = Bits == 64 ? ~word_type(0) : (word_type(1) << (Bits % 64)) - 1;
+
+		PackedDynArray();
+
+		// only the low Bits of a value are stored
+		value_type get(size_type) const;
+		void set(size_type, value_type);
+
+		value_type operator [](size_type) const;
+
+		// throws std::out_of_range
+		value_type at(size_type) const;
+
+		void push_back(value_type);
+		void pop_back();
+
+		// push_back()s "n" values
+		void append(const value_type* values, size_type n);
+
+		// writes elements ["first", "first" + "n") to "out"
+		// when Bits divides 64 evenly, no element straddles words, and whole words are unpacked with a fixed
+		// shift pattern the compiler can vectorize
+		void decode(size_type first, size_type n, value_type* out) const;
+
+		// new elements are 0
+		void resize(size_type);
+		void reserve(size_type);
+		void clear();
+
+		// how many bits are set over every element. For BitDynArray, the number of trues
+		size_type popcount() const;
+
+		size_type size() const;
+		bool empty() const;
+
+		// the packed words, for writing them out somewhere
+		const word_type* words() const;
+		size_type wordCount() const;
+
+	private:
+		static size_type wordsFor(size_type count);
+
+		// zeros every bit from "bit" on
+		void zeroFrom(size_type bit);
+
+		void decode(size_type first, size_type n, value_type* out, std::true_type wordAligned) const;
+		void decode(size_type first, size_type n, value_type* out, std::false_type wordAligned) const;
+
+		DynArray<word_type> storage;
+		size_type count;
+};
+
+// packed bools, 1 bit each
+using BitDynArray = PackedDynArray<1, bool>;
+
+template<std::size_t Bits, typename T>
+constexpr std::size_t PackedDynArray<Bits, T>::bitsPerWord;
+
+template<std::size_t Bits, typename T>
+constexpr typename PackedDynArray<Bits, T>::word_type PackedDynArray<Bits, T>::mask;
+
+template<std::size_t Bits, typename T>
+PackedDynArray<Bits, T>::PackedDynArray()
+:	count(0)
+{
+	storage.push_back(0);
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::value_type PackedDynArray<Bits, T>::get(size_type i) const
+{
+	const size_type bit = i * Bits;
+	const size_type word = bit / bitsPerWord;
+	const size_type offset = bit % bitsPerWord;
+
+	// the high part comes from the next word. Shifting in two steps makes an offset of 0 shift it out entirely
+	const word_type low = storage[word] >> offset;
+	const word_type high = (storage[word + 1] << 1) << (bitsPerWord - 1 - offset);
+
+	return static_cast<value_type>((low | high) & mask);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::set(size_type i, value_type value)
+{
+	const word_type bits = static_cast<word_type>(value) & mask;
+
+	const size_type bit = i * Bits;
+	const size_type word = bit / bitsPerWord;
+	const size_type offset = bit % bitsPerWord;
+
+	storage[word] = (storage[word] & ~(mask << offset)) | (bits << offset);
+
+	const word_type highMask = (mask >> 1) >> (bitsPerWord - 1 - offset);
+	const word_type high = (bits >> 1) >> (bitsPerWord - 1 - offset);
+
+	storage[word + 1] = (storage[word + 1] & ~highMask) | high;
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::value_type PackedDynArray<Bits, T>::operator [](size_type i) const
+{
+	return get(i);
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::value_type PackedDynArray<Bits, T>::at(size_type i) const
+{
+	if(i >= count)
+		throw std::out_of_range("PackedDynArray::at");
+
+	return get(i);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::push_back(value_type value)
+{
+	resize(count + 1);
+	set(count - 1, value);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::pop_back()
+{
+	resize(count - 1);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::append(const value_type* values, size_type n)
+{
+	const size_type first = count;
+	resize(count + n);
+
+	for(size_type i = 0; i < n; ++i)
+		set(first + i, values[i]);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::decode(size_type first, size_type n, value_type* out) const
+{
+	decode(first, n, out, std::integral_constant<bool, bitsPerWord % Bits == 0>{});
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::resize(size_type n)
+{
+	if(n < count)
+		zeroFrom(n * Bits);
+
+	// spare bits are always 0, so growing only needs the words
+	const size_type words = wordsFor(n);
+
+	// prepare() grows geometrically, so pushing one element at a time doesn't reallocate every few words
+	if(words > storage.size())
+	{
+		const size_type added = words - storage.size();
+		std::fill_n(storage.prepare(added), added, word_type(0));
+		storage.commit(added);
+	}
+	else
+	{
+		while(storage.size() > words)
+			storage.pop_back();
+	}
+
+	count = n;
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::reserve(size_type n)
+{
+	storage.reserve(wordsFor(n));
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::clear()
+{
+	storage.clear();
+	storage.push_back(0);
+	count = 0;
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::size_type PackedDynArray<Bits, T>::popcount() const
+{
+	size_type total = 0;
+
+	for(size_type i = 0; i < storage.size(); ++i)
+		total += dbr::impl::popcount(storage[i]);
+
+	return total;
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::size_type PackedDynArray<Bits, T>::size() const
+{
+	return count;
+}
+
+template<std::size_t Bits, typename T>
+bool PackedDynArray<Bits, T>::empty() const
+{
+	return count == 0;
+}
+
+template<std::size_t Bits, typename T>
+const typename PackedDynArray<Bits, T>::word_type* PackedDynArray<Bits, T>::words() const
+{
+	return storage.data();
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::size_type PackedDynArray<Bits, T>::wordCount() const
+{
+	return storage.size();
+}
+
+template<std::size_t Bits, typename T>
+typename PackedDynArray<Bits, T>::size_type PackedDynArray<Bits, T>::wordsFor(size_type n)
+{
+	// plus the spare
+	return (n * Bits + bitsPerWord - 1) / bitsPerWord + 1;
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::zeroFrom(size_type bit)
+{
+	const size_type word = bit / bitsPerWord;
+	const size_type offset = bit % bitsPerWord;
+
+	storage[word] &= offset == 0 ? 0 : ~word_type(0) >> (bitsPerWord - offset);
+
+	for(size_type i = word + 1; i < storage.size(); ++i)
+		storage[i] = 0;
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::decode(size_type first, size_type n, value_type* out, std::true_type) const
+{
+	constexpr size_type perWord = bitsPerWord / Bits;
+
+	size_type i = 0;
+
+	// up to the first whole word
+	for(; i < n && (first + i) % perWord != 0; ++i)
+		out[i] = get(first + i);
+
+	for(size_type word = (first + i) / perWord; i + perWord <= n; i += perWord, ++word)
+	{
+		const word_type bits = storage[word];
+
+		for(size_type j = 0; j < perWord; ++j)
+			out[i + j] = static_cast<value_type>((bits >> (j * Bits)) & mask);
+	}
+
+	for(; i < n; ++i)
+		out[i] = get(first + i);
+}
+
+template<std::size_t Bits, typename T>
+void PackedDynArray<Bits, T>::decode(size_type first, size_type n, value_type* out, std::false_type) const
+{
+	for(size_type i = 0; i < n; ++i)
+		out[i] = get(first + i);
+}
+
+#endif
@@ -0,0 +1,387 @@
+#ifndef PARALLEL_ALGORITHMS_HPP
+#define PARALLEL_ALGORITHMS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "DynArray.hpp"
+#include "ThreadPool.hpp"
+
+// whole array passes over DynArrays, split up across a ThreadPool
+// each thread gets chunks that start on their own cache line, so no two threads write to the same one
+// arrays smaller than serialThreshold aren't worth waking threads up for, and are just done on this one
+namespace dbr
+{
+	namespace parallel
+	{
+		constexpr std::size_t cacheLine = 64;
+
+		// below this many elements, everything runs on the calling thread
+		constexpr std::size_t serialThreshold = 1 << 15;
+
+		// calls "fn" on every element
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Fn>
+		void for_each(DynArray<T, Alloc, Growth, Observer>& array, Fn fn, ThreadPool& pool = ThreadPool::global());
+
+		// out[i] = fn(in[i]), "out" is resized to fit (and can be "in")
+		template<typename T, typename A, typename G, typename O, typename U, typename B, typename H, typename P, typename Fn>
+		void transform(const DynArray<T, A, G, O>& in, DynArray<U, B, H, P>& out, Fn fn, ThreadPool& pool = ThreadPool::global());
+
+		// folds the elements into "init" with "op", which must be associative (but not necessarily commutative)
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Op = std::plus<T>>
+		T reduce(const DynArray<T, Alloc, Growth, Observer>& array, T init, Op op = Op{}, ThreadPool& pool = ThreadPool::global());
+
+		// out[i] = in[0] op in[1] op ... op in[i], "out" is resized to fit (and can be "in")
+		// "op" must be associative
+		template<typename T, typename A, typename G, typename O, typename B, typename H, typename P, typename Op = std::plus<T>>
+		void inclusive_scan(const DynArray<T, A, G, O>& in, DynArray<T, B, H, P>& out, Op op = Op{}, ThreadPool& pool = ThreadPool::global());
+
+		// chunks are sorted in parallel, then merged pairwise in parallel
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Compare = std::less<T>>
+		void sort(DynArray<T, Alloc, Growth, Observer>& array, Compare comp = Compare{}, ThreadPool& pool = ThreadPool::global());
+
+		namespace impl
+		{
+			// splits "n" elements starting at "first" into chunks for "pool"
+			// every chunk but the first starts on a cache line (when elements fit evenly into cache lines)
+			// and every chunk is a whole number of cache lines long, apart from the ends
+			class Chunks
+			{
+				public:
+					template<typename T>
+					Chunks(const T* first, std::size_t n, const ThreadPool& pool);
+
+					std::size_t count() const;
+					std::size_t begin(std::size_t chunk) const;
+					std::size_t end(std::size_t chunk) const;
+
+				private:
+					std::size_t n;
+
+					// elements before the first cache line boundary
+					std::size_t head;
+
+					std::size_t size;
+					std::size_t chunks;
+			};
+
+			template<typename T>
+			Chunks::Chunks(const T* first, std::size_t n, const ThreadPool& pool)
+			:	n(n),
+				head(0),
+				size(n),
+				chunks(n ? 1 : 0)
+			{
+				if(n < serialThreshold || pool.size() == 1)
+					return;
+
+				const bool lineMultiple = cacheLine % sizeof(T) == 0;
+				const std::size_t perLine = lineMultiple ? cacheLine / sizeof(T) : 1;
+
+				if(lineMultiple)
+				{
+					const std::size_t misalign = reinterpret_cast<std::uintptr_t>(first) % cacheLine;
+
+					if(misalign % sizeof(T) == 0)
+						head = (cacheLine - misalign) % cacheLine / sizeof(T);
+				}
+
+				// a few chunks per thread, so one slow thread doesn't hold up the rest
+				const std::size_t parts = pool.size() * 4;
+				const std::size_t rest = n - head;
+
+				size = (rest + parts - 1) / parts;
+				size = (size + perLine - 1) / perLine * perLine;
+
+				chunks = (rest + size - 1) / size;
+
+				// the head goes in with the first chunk
+				if(chunks == 0)
+					chunks = 1;
+			}
+
+			inline std::size_t Chunks::count() const
+			{
+				return chunks;
+			}
+
+			inline std::size_t Chunks::begin(std::size_t chunk) const
+			{
+				return chunk == 0 ? 0 : std::min(n, head + chunk * size);
+			}
+
+			inline std::size_t Chunks::end(std::size_t chunk) const
+			{
+				return std::min(n, head + (chunk + 1) * size);
+			}
+
+			// runs "fn(begin, end)" for every chunk, on the pool if there's more than one
+			template<typename Fn>
+			void forChunks(const Chunks& chunks, Fn fn, ThreadPool& pool)
+			{
+				if(chunks.count() == 1)
+				{
+					fn(chunks.begin(0), chunks.end(0));
+					return;
+				}
+
+				pool.parallelFor(chunks.count(), [&](std::size_t c)
+				{
+					fn(chunks.begin(c), chunks.end(c));
+				});
+			}
+
+			template<typename T>
+			void destroy(T* first, T* last)
+			{
+				for(; first != last; ++first)
+					first->~T();
+			}
+
+			// constructs "n" elements at "to", the spare room at the end of (empty) "out", then commits them
+			// split into "parts", "range(p)" being the [first, last) of part p, and element i is made from "make(i, first)"
+			// (it can use the elements before it in its part). If any of them throw, every element made is destroyed again
+			template<typename U, typename B, typename H, typename P, typename Range, typename Make>
+			void constructParts(DynArray<U, B, H, P>& out, U* to, std::size_t n, std::size_t parts, Range range, Make make, ThreadPool& pool)
+			{
+				// which parts are done, so they can be destroyed if another one throws
+				DynArray<unsigned char> done(parts, 0);
+
+				auto build = [&](std::size_t p)
+				{
+					const std::pair<std::size_t, std::size_t> bounds = range(p);
+					std::size_t i = bounds.first;
+
+					try
+					{
+						for(; i < bounds.second; ++i)
+							new (to + i) U(make(i, bounds.first));
+					}
+					catch(...)
+					{
+						destroy(to + bounds.first, to + i);
+						throw;
+					}
+
+					done[p] = 1;
+				};
+
+				try
+				{
+					if(parts == 1)
+						build(0);
+					else
+						pool.parallelFor(parts, build);
+				}
+				catch(...)
+				{
+					for(std::size_t p = 0; p < parts; ++p)
+					{
+						if(done[p])
+							destroy(to + range(p).first, to + range(p).second);
+					}
+
+					throw;
+				}
+
+				out.commit(n);
+			}
+
+			// the same DynArray, even if "in" and "out" are different types of them
+			template<typename In, typename Out>
+			bool same(const In& in, const Out& out)
+			{
+				return static_cast<const void*>(&in) == static_cast<const void*>(&out);
+			}
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Fn>
+		void for_each(DynArray<T, Alloc, Growth, Observer>& array, Fn fn, ThreadPool& pool)
+		{
+			T* data = array.data();
+			const impl::Chunks chunks(data, array.size(), pool);
+
+			impl::forChunks(chunks, [&](std::size_t begin, std::size_t end)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					fn(data[i]);
+			}, pool);
+		}
+
+		template<typename T, typename A, typename G, typename O, typename U, typename B, typename H, typename P, typename Fn>
+		void transform(const DynArray<T, A, G, O>& in, DynArray<U, B, H, P>& out, Fn fn, ThreadPool& pool)
+		{
+			const std::size_t n = in.size();
+			const T* src = in.data();
+
+			// if "out" is "in", the elements are already there to assign to
+			if(impl::same(in, out))
+			{
+				U* dst = out.data();
+				const impl::Chunks chunks(dst, n, pool);
+
+				impl::forChunks(chunks, [&](std::size_t begin, std::size_t end)
+				{
+					for(std::size_t i = begin; i < end; ++i)
+						dst[i] = fn(src[i]);
+				}, pool);
+
+				return;
+			}
+
+			// otherwise they're constructed straight from fn's results, so U needn't be default constructible
+			out.clear();
+			U* dst = out.prepare(n);
+
+			// split by the output, it's the one being written to
+			const impl::Chunks chunks(dst, n, pool);
+
+			impl::constructParts(out, dst, n, chunks.count(), [&](std::size_t c)
+			{
+				return std::make_pair(chunks.begin(c), chunks.end(c));
+			},
+			[&](std::size_t i, std::size_t)
+			{
+				return fn(src[i]);
+			}, pool);
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Op>
+		T reduce(const DynArray<T, Alloc, Growth, Observer>& array, T init, Op op, ThreadPool& pool)
+		{
+			const T* data = array.data();
+			const impl::Chunks chunks(data, array.size(), pool);
+
+			if(chunks.count() == 1)
+			{
+				for(std::size_t i = 0; i < array.size(); ++i)
+					init = op(std::move(init), data[i]);
+
+				return init;
+			}
+
+			// each chunk folds into its own first element, so "op" needs no identity
+			// and each total is constructed in place, so T needn't be default constructible
+			DynArray<T> partials(chunks.count());
+
+			impl::constructParts(partials, partials.prepare(chunks.count()), chunks.count(), chunks.count(), [](std::size_t c)
+			{
+				return std::make_pair(c, c + 1);
+			},
+			[&](std::size_t c, std::size_t)
+			{
+				const std::size_t end = chunks.end(c);
+
+				T sum = data[chunks.begin(c)];
+				for(std::size_t i = chunks.begin(c) + 1; i < end; ++i)
+					sum = op(std::move(sum), data[i]);
+
+				return sum;
+			}, pool);
+
+			for(std::size_t c = 0; c < chunks.count(); ++c)
+				init = op(std::move(init), partials[c]);
+
+			return init;
+		}
+
+		template<typename T, typename A, typename G, typename O, typename B, typename H, typename P, typename Op>
+		void inclusive_scan(const DynArray<T, A, G, O>& in, DynArray<T, B, H, P>& out, Op op, ThreadPool& pool)
+		{
+			const std::size_t n = in.size();
+			const T* src = in.data();
+
+			if(n == 0)
+			{
+				out.clear();
+				return;
+			}
+
+			// if "out" is "in", each chunk is scanned in place. Otherwise each element is constructed from the one before it,
+			// so T needn't be default constructible
+			const bool inPlace = impl::same(in, out);
+
+			if(!inPlace)
+				out.clear();
+
+			T* dst = inPlace ? out.data() : out.prepare(n);
+			const impl::Chunks chunks(dst, n, pool);
+
+			if(inPlace)
+			{
+				impl::forChunks(chunks, [&](std::size_t begin, std::size_t end)
+				{
+					for(std::size_t i = begin + 1; i < end; ++i)
+						dst[i] = op(dst[i - 1], src[i]);
+				}, pool);
+			}
+			else
+			{
+				impl::constructParts(out, dst, n, chunks.count(), [&](std::size_t c)
+				{
+					return std::make_pair(chunks.begin(c), chunks.end(c));
+				},
+				[&](std::size_t i, std::size_t first)
+				{
+					return i == first ? src[i] : op(dst[i - 1], src[i]);
+				}, pool);
+			}
+
+			if(chunks.count() == 1)
+				return;
+
+			// each chunk was scanned on its own, now add what came before each chunk onto it
+			// carries[c - 1] is what comes before chunk c, ie: the running total of the chunk totals
+			DynArray<T> carries(chunks.count());
+
+			carries.push_back(dst[chunks.end(0) - 1]);
+			for(std::size_t c = 2; c < chunks.count(); ++c)
+				carries.push_back(op(carries[c - 2], dst[chunks.end(c - 1) - 1]));
+
+			pool.parallelFor(chunks.count() - 1, [&](std::size_t c)
+			{
+				const T& carry = carries[c];
+				++c;
+
+				for(std::size_t i = chunks.begin(c); i < chunks.end(c); ++i)
+					dst[i] = op(carry, dst[i]);
+			});
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer, typename Compare>
+		void sort(DynArray<T, Alloc, Growth, Observer>& array, Compare comp, ThreadPool& pool)
+		{
+			T* data = array.data();
+			const impl::Chunks chunks(data, array.size(), pool);
+
+			impl::forChunks(chunks, [&](std::size_t begin, std::size_t end)
+			{
+				std::sort(data + begin, data + end, comp);
+			}, pool);
+
+			// merge neighbouring runs of "width" chunks, doubling the width each pass
+			for(std::size_t width = 1; width < chunks.count(); width *= 2)
+			{
+				const std::size_t merges = (chunks.count() + 2 * width - 1) / (2 * width);
+
+				pool.parallelFor(merges, [&](std::size_t m)
+				{
+					const std::size_t left = m * 2 * width;
+					const std::size_t right = left + width;
+
+					if(right >= chunks.count())
+						return;
+
+					const std::size_t end = std::min(right + width, chunks.count()) - 1;
+
+					std::inplace_merge(data + chunks.begin(left), data + chunks.begin(right), data + chunks.end(end), comp);
+				});
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "PoolAllocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace swift
+{
+	constexpr std::size_t Pool::defaultSlabSize;
+
+	Pool::Pool(std::size_t blockSize, std::size_t alignment, std::size_t slabSize)
+	:	requestedSize(blockSize),
+		align(std::max(alignment, alignof(FreeBlock))),
+		slabs(nullptr),
+		freeList(nullptr),
+		fresh(nullptr),
+		freshEnd(nullptr),
+		usedBlocks(0),
+		capacityBlocks(0)
+	{
+		const std::size_t size = std::max(blockSize, sizeof(FreeBlock));
+		stride = (size + align - 1) / align * align;
+
+		blocksPerSlab = std::max<std::size_t>(1, (slabSize - std::min(slabSize, sizeof(Slab))) / stride);
+	}
+
+	Pool::~Pool()
+	{
+		while(slabs)
+		{
+			Slab* next = slabs->next;
+			::operator delete(slabs);
+			slabs = next;
+		}
+	}
+
+	void* Pool::allocate()
+	{
+		void* block;
+
+		if(freeList)
+		{
+			block = freeList;
+			freeList = freeList->next;
+		}
+		else
+		{
+			if(fresh == freshEnd)
+				newSlab();
+
+			block = fresh;
+			fresh += stride;
+		}
+
+		++usedBlocks;
+		return block;
+	}
+
+	void Pool::deallocate(void* ptr)
+	{
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		block->next = freeList;
+		freeList = block;
+
+		--usedBlocks;
+	}
+
+	std::size_t Pool::blockSize() const
+	{
+		return requestedSize;
+	}
+
+	std::size_t Pool::alignment() const
+	{
+		return align;
+	}
+
+	std::size_t Pool::used() const
+	{
+		return usedBlocks;
+	}
+
+	std::size_t Pool::capacity() const
+	{
+		return capacityBlocks;
+	}
+
+	void Pool::newSlab()
+	{
+		// room for the header, and for aligning the first block past it
+		Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab) + align + blocksPerSlab * stride));
+		slab->next = slabs;
+		slabs = slab;
+
+		const std::uintptr_t afterHeader = reinterpret_cast<std::uintptr_t>(slab + 1);
+		fresh = reinterpret_cast<char*>(slab + 1) + (align - afterHeader % align) % align;
+		freshEnd = fresh + blocksPerSlab * stride;
+
+		capacityBlocks += blocksPerSlab;
+	}
+
+	Pool& Pools::get(std::size_t blockSize, std::size_t alignment)
+	{
+		// any Pool aligned at least as strictly will do
+		for(auto& pool : pools)
+		{
+			if(pool->blockSize() == blockSize && pool->alignment() >= alignment)
+				return *pool;
+		}
+
+		std::unique_ptr<Pool> pool(new Pool(blockSize, alignment));
+		pools.push_back(std::move(pool));
+
+		return *pools.back();
+	}
+
+	const std::shared_ptr<Pools>& Pools::threadDefault()
+	{
+		thread_local const std::shared_ptr<Pools> pools = std::make_shared<Pools>();
+		return pools;
+	}
+}
@@ -0,0 +1,253 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace swift
+{
+	// hands out blocks of one size in O(1), carved out of big contiguous slabs
+	// freed blocks go on a free list and are handed out again first, so blocks allocated together stay close together,
+	// and the general heap never sees (or fragments over) the individual blocks
+	// slabs are only given back when the Pool is destroyed
+	// not thread safe
+	class Pool
+	{
+		public:
+			static constexpr std::size_t defaultSlabSize = 16 * 1024;
+
+			// blocks of at least "blockSize" bytes aligned to "alignment", about "slabSize" bytes of them at a time
+			explicit Pool(std::size_t blockSize, std::size_t alignment = alignof(std::max_align_t), std::size_t slabSize = defaultSlabSize);
+
+			Pool(const Pool&) = delete;
+			Pool& operator =(const Pool&) = delete;
+
+			~Pool();
+
+			// throws std::bad_alloc if a new slab is needed and can't be had
+			void* allocate();
+			void deallocate(void* ptr);
+
+			std::size_t blockSize() const;
+			std::size_t alignment() const;
+
+			// blocks handed out, and blocks held in slabs
+			std::size_t used() const;
+			std::size_t capacity() const;
+
+		private:
+			// free blocks double as the free list's links
+			struct FreeBlock
+			{
+				FreeBlock* next;
+			};
+
+			// slabs start with one of these, followed by the blocks
+			struct Slab
+			{
+				Slab* next;
+			};
+
+			void newSlab();
+
+			std::size_t requestedSize;
+			std::size_t align;
+
+			// distance between blocks: the size, with room for a link, rounded up to the alignment
+			std::size_t stride;
+			std::size_t blocksPerSlab;
+
+			Slab* slabs;
+			FreeBlock* freeList;
+
+			// the part of the newest slab that's never been handed out
+			char* fresh;
+			char* freshEnd;
+
+			std::size_t usedBlocks;
+			std::size_t capacityBlocks;
+	};
+
+	// the Pools a PoolAllocator and all of its copies and rebinds share, one per block size
+	// (ie: a std::map rebinds its allocator to its node type, which only it knows the size of)
+	class Pools
+	{
+		public:
+			Pools() = default;
+
+			Pools(const Pools&) = delete;
+			Pools& operator =(const Pools&) = delete;
+
+			// the Pool for blocks of "blockSize" bytes aligned to "alignment", made the first time it's asked for
+			Pool& get(std::size_t blockSize, std::size_t alignment);
+
+			// the calling thread's Pools, made the first time it's asked for, which default constructed PoolAllocators share
+			// it lives as long as the thread, or the last allocator using it if that's longer
+			static const std::shared_ptr<Pools>& threadDefault();
+
+		private:
+			std::vector<std::unique_ptr<Pool>> pools;
+	};
+
+	// a standard allocator over Pools: blocks of up to BlockCount Ts come from a Pool, anything bigger from the heap
+	// with the default of 1, that's node based containers (std::map, std::list, ...) allocating every node from a Pool
+	// a DynArray<T, PoolAllocator<T, N>> gets its first N elements' worth from a Pool, and grows onto the heap from there
+	// copies share the same Pools, and compare equal. Not thread safe: default constructed ones share their thread's Pools,
+	// so a container made with one shouldn't be used from another thread while its own thread is still using its Pools
+	template<typename T, std::size_t BlockCount = 1>
+	class PoolAllocator
+	{
+		static_assert(BlockCount > 0, "PoolAllocator blocks need room for at least one T");
+
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			struct allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+			template<typename U>
+			struct rebind
+			{
+				using other = PoolAllocator<U, BlockCount>;
+			};
+
+			// sharing the calling thread's default Pools, so making one doesn't allocate (past the first on a thread)
+			PoolAllocator();
+
+			// sharing "pools", ie: to give a container (and everything that copies its allocator) Pools of its own
+			explicit PoolAllocator(std::shared_ptr<Pools> pools);
+
+			// copies (and moves, so a moved from container can still allocate) share the Pools
+			PoolAllocator(const PoolAllocator&);
+
+			template<typename U>
+			PoolAllocator(const PoolAllocator<U, BlockCount>&);
+
+			PoolAllocator& operator =(const PoolAllocator&);
+
+			pointer allocate(size_type n);
+			allocation_result allocate_at_least(size_type n);
+			void deallocate(pointer ptr, size_type n);
+
+			Pools& pools() const;
+
+			template<typename U, typename V, std::size_t N>
+			friend bool operator ==(const PoolAllocator<U, N>&, const PoolAllocator<V, N>&);
+
+			template<typename U, typename V, std::size_t N>
+			friend bool operator !=(const PoolAllocator<U, N>&, const PoolAllocator<V, N>&);
+
+		private:
+			template<typename U, std::size_t N>
+			friend class PoolAllocator;
+
+			Pool& pool();
+
+			std::shared_ptr<Pools> shared;
+
+			// found the first time it's needed, since T can still be incomplete when we're made
+			Pool* cached;
+	};
+
+	template<typename T, std::size_t BlockCount>
+	PoolAllocator<T, BlockCount>::PoolAllocator()
+	:	shared(Pools::threadDefault()),
+		cached(nullptr)
+	{}
+
+	template<typename T, std::size_t BlockCount>
+	PoolAllocator<T, BlockCount>::PoolAllocator(std::shared_ptr<Pools> pools)
+	:	shared(std::move(pools)),
+		cached(nullptr)
+	{}
+
+	template<typename T, std::size_t BlockCount>
+	PoolAllocator<T, BlockCount>::PoolAllocator(const PoolAllocator& other)
+	:	shared(other.shared),
+		cached(other.cached)
+	{}
+
+	template<typename T, std::size_t BlockCount>
+	template<typename U>
+	PoolAllocator<T, BlockCount>::PoolAllocator(const PoolAllocator<U, BlockCount>& other)
+	:	shared(other.shared),
+		cached(nullptr)
+	{}
+
+	template<typename T, std::size_t BlockCount>
+	PoolAllocator<T, BlockCount>& PoolAllocator<T, BlockCount>::operator =(const PoolAllocator& other)
+	{
+		shared = other.shared;
+		cached = other.cached;
+		return *this;
+	}
+
+	template<typename T, std::size_t BlockCount>
+	typename PoolAllocator<T, BlockCount>::pointer PoolAllocator<T, BlockCount>::allocate(size_type n)
+	{
+		return allocate_at_least(n).ptr;
+	}
+
+	template<typename T, std::size_t BlockCount>
+	typename PoolAllocator<T, BlockCount>::allocation_result PoolAllocator<T, BlockCount>::allocate_at_least(size_type n)
+	{
+		if(n <= BlockCount)
+			return {static_cast<pointer>(pool().allocate()), BlockCount};
+
+		if(n > std::numeric_limits<size_type>::max() / sizeof(T))
+			throw std::bad_alloc();
+
+		return {static_cast<pointer>(::operator new(n * sizeof(T))), n};
+	}
+
+	template<typename T, std::size_t BlockCount>
+	void PoolAllocator<T, BlockCount>::deallocate(pointer ptr, size_type n)
+	{
+		if(n <= BlockCount)
+			pool().deallocate(ptr);
+		else
+			::operator delete(ptr);
+	}
+
+	template<typename T, std::size_t BlockCount>
+	Pools& PoolAllocator<T, BlockCount>::pools() const
+	{
+		return *shared;
+	}
+
+	template<typename T, std::size_t BlockCount>
+	Pool& PoolAllocator<T, BlockCount>::pool()
+	{
+		if(!cached)
+			cached = &shared->get(sizeof(T) * BlockCount, alignof(T));
+
+		return *cached;
+	}
+
+	template<typename U, typename V, std::size_t N>
+	bool operator ==(const PoolAllocator<U, N>& lhs, const PoolAllocator<V, N>& rhs)
+	{
+		return lhs.shared == rhs.shared;
+	}
+
+	template<typename U, typename V, std::size_t N>
+	bool operator !=(const PoolAllocator<U, N>& lhs, const PoolAllocator<V, N>& rhs)
+	{
+		return lhs.shared != rhs.shared;
+	}
+}
+
+#endif
@@ -8,26 +8,36 @@ QuadTree::QuadTree(std::size_t w, std::size_t h)
 :	QuadTree(0, 0, w, h)
 {}
 
+// Pools of the tree's own, so it can be built on one thread and used or destroyed on another
 QuadTree::QuadTree(std::size_t tlx, std::size_t tly, std::size_t w, std::size_t h)
+:	QuadTree(tlx, tly, w, h, Children::allocator_type(std::make_shared<swift::Pools>()))
+{}
+
+QuadTree::QuadTree(std::size_t tlx, std::size_t tly, std::size_t w, std::size_t h, const Children::allocator_type& alloc)
 :	topLeftX(tlx),
 	topLeftY(tly),
 	width(w),
-	height(h)
+	height(h),
+	childrenMap(alloc)
 {}
 
 void QuadTree::add(const Rectangle& rect)
 {
 	Corner placeIn = index(rect);
 
-	if(!children.empty() && placeIn != Corner::Parent)
+	if(!childrenMap.empty() && placeIn != Corner::Parent)
 	{
-		children[placeIn].add(rect);
+		childrenMap.at(placeIn).add(rect);
 	}
 	else
 	{
+		// a leaf splits once it goes over maxObjects, so that's usually all the room it needs
+		if(objectsArr.empty())
+			objectsArr.reserve(maxObjects + 1);
+
 		objectsArr.emplace_back(rect);
 
-		if(children.empty() && objectsArr.size() > maxObjects)
+		if(childrenMap.empty() && objectsArr.size() > maxObjects)
 			split();
 	}
 }
@@ -91,10 +101,12 @@ void QuadTree::split()
 	std::size_t widthHalf = width / 2;
 	std::size_t heigthHalf = height / 2;
 
-	children.emplace(Corner::TopLeft, QuadTree(0, 0, widthHalf, heigthHalf));
-	children.emplace(Corner::TopRight, QuadTree(widthHalf, 0, widthHalf, heigthHalf));
-	children.emplace(Corner::BotLeft, QuadTree(0, heigthHalf, widthHalf, heigthHalf));
-	children.emplace(Corner::BotRight, QuadTree(widthHalf, heigthHalf, widthHalf, heigthHalf));
+	const Children::allocator_type alloc = childrenMap.get_allocator();
+
+	childrenMap.emplace(Corner::TopLeft, QuadTree(0, 0, widthHalf, heigthHalf, alloc));
+	childrenMap.emplace(Corner::TopRight, QuadTree(widthHalf, 0, widthHalf, heigthHalf, alloc));
+	childrenMap.emplace(Corner::BotLeft, QuadTree(0, heigthHalf, widthHalf, heigthHalf, alloc));
+	childrenMap.emplace(Corner::BotRight, QuadTree(widthHalf, heigthHalf, widthHalf, heigthHalf, alloc));
 
 	Objects temp;
 	for(auto it = objectsArr.begin(); it != objectsArr.end(); ++it)
@@ -102,7 +114,7 @@ void QuadTree::split()
 		Corner placeIn = index(*it);
 
 		if(placeIn != Corner::Parent)
-			children[placeIn].add(*it);
+			childrenMap.at(placeIn).add(*it);
 		else
 			temp.emplace_back(*it);
 	}
@@ -5,6 +5,8 @@
 #include <map>
 #include <vector>
 
+#include "PoolAllocator.hpp"
+
 struct Rectangle
 {
 	std::size_t topLeftX;
@@ -26,12 +28,18 @@ class QuadTree
 		};
 		
 		using Objects = std::vector<std::reference_wrapper<const Rectangle>>;
-		using Children = std::map<Corner, QuadTree>;
+		// every node of a tree comes from the same Pool, so they're close together in memory
+		using Children = std::map<Corner, QuadTree, std::less<Corner>, swift::PoolAllocator<std::pair<const Corner, QuadTree>>>;
 
 		QuadTree();
 		QuadTree(std::size_t w, std::size_t h);
 		QuadTree(std::size_t tlx, std::size_t tly, std::size_t w, std::size_t h);
 
+		// the others make the tree Pools of its own
+		// this one allocates from "alloc"'s instead, ie: to have several trees (used from the same thread) share Pools.
+		// Children share their parent's
+		QuadTree(std::size_t tlx, std::size_t tly, std::size_t w, std::size_t h, const Children::allocator_type& alloc);
+
 		void add(const Rectangle& rect);
 
 		const Objects& objects() const;
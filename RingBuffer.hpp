@@ -0,0 +1,265 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "DynArray.hpp"
+
+namespace dbr
+{
+	namespace impl
+	{
+		inline std::size_t roundUpPow2(std::size_t n)
+		{
+			std::size_t pow2 = 1;
+			while(pow2 < n)
+				pow2 <<= 1;
+
+			return pow2;
+		}
+
+		// a power of two number of uninitialized slots for Ts, indexed by an ever increasing position
+		// positions wrap around with a mask instead of a division. Constructing and destroying Ts is up to the user
+		// the slots are a DynArray of raw storage, so they're allocated just like a DynArray's elements are
+		template<typename T, typename Alloc>
+		class RingSlots
+		{
+			private:
+				using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+				using StorageAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Storage>;
+
+			public:
+				explicit RingSlots(std::size_t capacity)
+				:	mask(roundUpPow2(capacity) - 1),
+					slots(mask + 1)
+				{
+					slots.resizeUninitialized(mask + 1);
+				}
+
+				T* operator [](std::size_t pos)
+				{
+					return reinterpret_cast<T*>(&slots[pos & mask]);
+				}
+
+				const T* operator [](std::size_t pos) const
+				{
+					return reinterpret_cast<const T*>(&slots[pos & mask]);
+				}
+
+				std::size_t capacity() const
+				{
+					return mask + 1;
+				}
+
+			private:
+				// before the slots, which are made with room for exactly mask + 1
+				std::size_t mask;
+				DynArray<Storage, StorageAlloc> slots;
+		};
+	}
+}
+
+// a fixed capacity FIFO: push at the back, pop from the front, both O(1), and nothing is ever moved
+// the capacity is rounded up to a power of two. Pushing to a full RingBuffer fails rather than growing
+// not thread safe, see SpscQueue and MpmcQueue for that
+template<typename T, typename Alloc = std::allocator<T>>
+class RingBuffer
+{
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using reference = T&;
+		using const_reference = const T&;
+
+		explicit RingBuffer(size_type capacity);
+
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator =(const RingBuffer&) = delete;
+
+		~RingBuffer();
+
+		// these return false if it's full
+		template<typename... Args>
+		bool emplace_back(Args&&...);
+
+		bool push_back(const_reference);
+		bool push_back(T&&);
+
+		void pop_front();
+
+		// moves as many of "values" in as there's room for, and returns how many that was
+		size_type pushBatch(T* values, size_type n);
+
+		// moves up to "n" elements out to "out", and returns how many that was
+		size_type popBatch(T* out, size_type n);
+
+		// 0 is the front
+		reference operator [](size_type);
+		const_reference operator [](size_type) const;
+
+		reference front();
+		const_reference front() const;
+
+		reference back();
+		const_reference back() const;
+
+		void clear();
+
+		size_type size() const;
+		size_type capacity() const;
+
+		bool empty() const;
+		bool full() const;
+
+	private:
+		dbr::impl::RingSlots<T, Alloc> slots;
+
+		// position of the front
+		size_type head;
+		size_type count;
+};
+
+template<typename T, typename Alloc>
+RingBuffer<T, Alloc>::RingBuffer(size_type capacity)
+:	slots(capacity),
+	head(0),
+	count(0)
+{}
+
+template<typename T, typename Alloc>
+RingBuffer<T, Alloc>::~RingBuffer()
+{
+	clear();
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+bool RingBuffer<T, Alloc>::emplace_back(Args&&... args)
+{
+	if(full())
+		return false;
+
+	new (slots[head + count]) T(std::forward<Args>(args)...);
+	++count;
+
+	return true;
+}
+
+template<typename T, typename Alloc>
+bool RingBuffer<T, Alloc>::push_back(const_reference value)
+{
+	return emplace_back(value);
+}
+
+template<typename T, typename Alloc>
+bool RingBuffer<T, Alloc>::push_back(T&& value)
+{
+	return emplace_back(std::move(value));
+}
+
+template<typename T, typename Alloc>
+void RingBuffer<T, Alloc>::pop_front()
+{
+	slots[head]->~T();
+
+	++head;
+	--count;
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::size_type RingBuffer<T, Alloc>::pushBatch(T* values, size_type n)
+{
+	size_type i = 0;
+
+	for(; i < n && !full(); ++i)
+		emplace_back(std::move(values[i]));
+
+	return i;
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::size_type RingBuffer<T, Alloc>::popBatch(T* out, size_type n)
+{
+	size_type i = 0;
+
+	for(; i < n && !empty(); ++i)
+	{
+		out[i] = std::move(front());
+		pop_front();
+	}
+
+	return i;
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::reference RingBuffer<T, Alloc>::operator [](size_type i)
+{
+	return *slots[head + i];
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::const_reference RingBuffer<T, Alloc>::operator [](size_type i) const
+{
+	return *slots[head + i];
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::reference RingBuffer<T, Alloc>::front()
+{
+	return (*this)[0];
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::const_reference RingBuffer<T, Alloc>::front() const
+{
+	return (*this)[0];
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::reference RingBuffer<T, Alloc>::back()
+{
+	return (*this)[count - 1];
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::const_reference RingBuffer<T, Alloc>::back() const
+{
+	return (*this)[count - 1];
+}
+
+template<typename T, typename Alloc>
+void RingBuffer<T, Alloc>::clear()
+{
+	while(!empty())
+		pop_front();
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::size_type RingBuffer<T, Alloc>::size() const
+{
+	return count;
+}
+
+template<typename T, typename Alloc>
+typename RingBuffer<T, Alloc>::size_type RingBuffer<T, Alloc>::capacity() const
+{
+	return slots.capacity();
+}
+
+template<typename T, typename Alloc>
+bool RingBuffer<T, Alloc>::empty() const
+{
+	return count == 0;
+}
+
+template<typename T, typename Alloc>
+bool RingBuffer<T, Alloc>::full() const
+{
+	return count == slots.capacity();
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "DynArray.hpp"
+#include "Hashing.hpp"
+
+// binary snapshots of DynArrays of trivially copyable types
+// a fixed size header, then the elements exactly as they are in memory, so writing is one write from data(),
+// and reading is one read into the array plus one checksum pass over it
+// the header has a checksum of its own, so a corrupt count is caught before anything is allocated for it.
+// The payload is only allocated for as it arrives, unless the stream can say up front that it's all there
+// the payload is raw, so a snapshot can only be read on a machine with the same element layout. The header is
+// checked for that (element size, alignment, and byte order by way of the magic number)
+namespace dbr
+{
+	namespace serial
+	{
+		// "DYNA", as a little endian uint32. Reads back as something else on a machine of the other byte order
+		constexpr std::uint32_t magic = 0x414e5944u;
+		constexpr std::uint16_t version = 2;
+
+		// laid out so there's no padding in it: 32 bytes, written as is
+		struct Header
+		{
+			std::uint32_t magic;
+			std::uint16_t version;
+			std::uint16_t alignment;
+			std::uint32_t elementSize;
+
+			// fletcher32 of the payload
+			std::uint32_t checksum;
+			std::uint64_t count;
+
+			// fletcher32 of everything above
+			std::uint32_t headerChecksum;
+			std::uint32_t reserved;
+		};
+
+		static_assert(sizeof(Header) == 32, "dbr::serial::Header must not have any padding");
+
+		// how much of the payload is read at once, when the stream can't tell how much it has
+		constexpr std::size_t readChunkBytes = 1 << 20;
+
+		// thrown when a snapshot can't be read back: it's cut short, corrupt, or for a different type or machine
+		class FormatError : public std::runtime_error
+		{
+			public:
+				explicit FormatError(const std::string& what)
+				:	std::runtime_error(what)
+				{}
+		};
+
+		// how many bytes writing "array" takes
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		std::size_t serializedSize(const DynArray<T, Alloc, Growth, Observer>& array);
+
+		// writes a snapshot of "array" to "out"
+		// throws std::ios_base::failure if "out" fails
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		void write(std::ostream& out, const DynArray<T, Alloc, Growth, Observer>& array);
+
+		// replaces the elements of "array" with a snapshot read from "in"
+		// throws FormatError if it isn't one of "array"'s type, and leaves "array" empty if the payload was bad
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		void read(std::istream& in, DynArray<T, Alloc, Growth, Observer>& array);
+
+		namespace impl
+		{
+			inline std::uint32_t headerChecksum(const Header& header)
+			{
+				return dbr::hash::fletcher32(reinterpret_cast<const std::uint8_t*>(&header), offsetof(Header, headerChecksum));
+			}
+
+			// how many bytes are left in "in", or -1 if it can't tell (ie: it's a pipe)
+			inline std::streamoff remaining(std::istream& in)
+			{
+				const std::streampos here = in.tellg();
+				if(here == std::streampos(-1))
+					return -1;
+
+				in.seekg(0, std::ios_base::end);
+				const std::streampos end = in.tellg();
+
+				in.clear();
+				in.seekg(here);
+
+				if(end == std::streampos(-1))
+					return -1;
+
+				return end - here;
+			}
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		std::size_t serializedSize(const DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			return sizeof(Header) + array.size() * sizeof(T);
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		void write(std::ostream& out, const DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only DynArrays of trivially copyable types can be serialized");
+
+			const std::size_t bytes = array.size() * sizeof(T);
+			const char* payload = reinterpret_cast<const char*>(array.data());
+
+			Header header;
+			header.magic = magic;
+			header.version = version;
+			header.alignment = alignof(T);
+			header.elementSize = sizeof(T);
+			header.checksum = dbr::hash::fletcher32(reinterpret_cast<const std::uint8_t*>(payload), bytes);
+			header.count = array.size();
+			header.reserved = 0;
+			header.headerChecksum = impl::headerChecksum(header);
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			out.write(payload, bytes);
+
+			if(!out)
+				throw std::ios_base::failure("dbr::serial::write: stream failed");
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		void read(std::istream& in, DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only DynArrays of trivially copyable types can be serialized");
+
+			Header header;
+			in.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+			if(in.gcount() != sizeof(Header))
+				throw FormatError("dbr::serial::read: header cut short");
+
+			if(header.magic != magic)
+				throw FormatError("dbr::serial::read: not a DynArray snapshot, or written with the other byte order");
+
+			if(impl::headerChecksum(header) != header.headerChecksum || header.reserved != 0)
+				throw FormatError("dbr::serial::read: header checksum mismatch");
+
+			if(header.version != version)
+				throw FormatError("dbr::serial::read: unsupported version " + std::to_string(header.version));
+
+			if(header.elementSize != sizeof(T) || header.alignment != alignof(T))
+				throw FormatError("dbr::serial::read: element size or alignment doesn't match");
+
+			if(header.count > array.max_size())
+				throw FormatError("dbr::serial::read: too many elements");
+
+			const std::size_t count = static_cast<std::size_t>(header.count);
+			const std::size_t bytes = count * sizeof(T);
+
+			// if the stream knows the payload's all there, it's read in one go. Otherwise a chunk at a time,
+			// so a count that's wrong (and got past the header checksum anyway) can't allocate much more than was actually sent
+			const std::streamoff left = impl::remaining(in);
+
+			if(left >= 0 && static_cast<std::uint64_t>(left) < bytes)
+				throw FormatError("dbr::serial::read: payload cut short");
+
+			const std::size_t chunk = left >= 0 ? count : std::max<std::size_t>(1, readChunkBytes / sizeof(T));
+
+			array.clear();
+
+			try
+			{
+				// straight into the array's memory
+				for(std::size_t done = 0; done < count;)
+				{
+					const std::size_t n = std::min(chunk, count - done);
+
+					in.read(reinterpret_cast<char*>(array.prepare(n)), n * sizeof(T));
+
+					if(static_cast<std::size_t>(in.gcount()) != n * sizeof(T))
+						throw FormatError("dbr::serial::read: payload cut short");
+
+					array.commit(n);
+					done += n;
+				}
+
+				if(dbr::hash::fletcher32(reinterpret_cast<const std::uint8_t*>(array.data()), bytes) != header.checksum)
+					throw FormatError("dbr::serial::read: checksum mismatch");
+			}
+			catch(...)
+			{
+				array.clear();
+				throw;
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,620 @@
+#ifndef SIMD_ALGORITHMS_HPP
+#define SIMD_ALGORITHMS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "DynArray.hpp"
+
+// find, count, min, max, sum and dot over DynArrays of arithmetic types, straight over data() rather than the iterators
+// int32s and floats get SSE2 and AVX2 kernels on x86 built with SSE2 (AVX2 picked at runtime, if the CPU has it),
+// everything else (and every other architecture) gets plain loops the compiler can vectorize itself
+// sums and dot products are added up in a different order than a plain loop would,
+// so float results can differ from one in the last few bits. Integer ones wrap around on overflow
+// min and max of floats with NaNs in them are unspecified
+
+// the SIMD kernels need SSE2 to be there at compile time: always on x86-64, only with -msse2 (or better) on 32 bit x86
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386)) && (defined(__GNUC__) || defined(__clang__))
+#	define DBR_SIMD_X86 1
+#	define DBR_SIMD_AVX2 __attribute__((target("avx2")))
+#	include <immintrin.h>
+#else
+#	define DBR_SIMD_X86 0
+#endif
+
+namespace dbr
+{
+	namespace simd
+	{
+		// the first element equal to "value", or end() if there isn't one
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		typename DynArray<T, Alloc, Growth, Observer>::const_iterator find(const DynArray<T, Alloc, Growth, Observer>& array, T value);
+
+		// how many elements are equal to "value"
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		std::size_t count(const DynArray<T, Alloc, Growth, Observer>& array, T value);
+
+		// throw std::invalid_argument for empty arrays
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T min(const DynArray<T, Alloc, Growth, Observer>& array);
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T max(const DynArray<T, Alloc, Growth, Observer>& array);
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T sum(const DynArray<T, Alloc, Growth, Observer>& array);
+
+		// throws std::invalid_argument if the arrays aren't the same size
+		template<typename T, typename A, typename G, typename O, typename B, typename H, typename P>
+		T dot(const DynArray<T, A, G, O>& lhs, const DynArray<T, B, H, P>& rhs);
+
+		namespace impl
+		{
+			// scalar kernels, for every type
+			template<typename T>
+			std::size_t find(const T* data, std::size_t n, T value)
+			{
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					if(data[i] == value)
+						return i;
+				}
+
+				return n;
+			}
+
+			template<typename T>
+			std::size_t count(const T* data, std::size_t n, T value)
+			{
+				std::size_t found = 0;
+
+				for(std::size_t i = 0; i < n; ++i)
+					found += data[i] == value;
+
+				return found;
+			}
+
+			// "n" must not be 0
+			template<typename T>
+			T min(const T* data, std::size_t n)
+			{
+				T least = data[0];
+
+				for(std::size_t i = 1; i < n; ++i)
+					least = data[i] < least ? data[i] : least;
+
+				return least;
+			}
+
+			template<typename T>
+			T max(const T* data, std::size_t n)
+			{
+				T most = data[0];
+
+				for(std::size_t i = 1; i < n; ++i)
+					most = most < data[i] ? data[i] : most;
+
+				return most;
+			}
+
+			// integers are added up unsigned, so overflow wraps instead of being undefined
+			template<typename T>
+			using Accumulator = typename std::conditional<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+				std::make_unsigned<T>, std::common_type<T>>::type::type;
+
+			template<typename T>
+			T sum(const T* data, std::size_t n)
+			{
+				Accumulator<T> total = 0;
+
+				for(std::size_t i = 0; i < n; ++i)
+					total += static_cast<Accumulator<T>>(data[i]);
+
+				return static_cast<T>(total);
+			}
+
+			template<typename T>
+			T dot(const T* lhs, const T* rhs, std::size_t n)
+			{
+				Accumulator<T> total = 0;
+
+				for(std::size_t i = 0; i < n; ++i)
+					total += static_cast<Accumulator<T>>(lhs[i]) * static_cast<Accumulator<T>>(rhs[i]);
+
+				return static_cast<T>(total);
+			}
+
+#if DBR_SIMD_X86
+			inline bool hasAVX2()
+			{
+				static const bool has = __builtin_cpu_supports("avx2");
+				return has;
+			}
+
+			// horizontal reductions of a vector's lanes, through memory since it only happens once per call
+			template<typename T, typename V>
+			T minLanes(const V& v)
+			{
+				T lanes[sizeof(V) / sizeof(T)];
+				std::memcpy(lanes, &v, sizeof(V));
+				return min(lanes, sizeof(V) / sizeof(T));
+			}
+
+			template<typename T, typename V>
+			T maxLanes(const V& v)
+			{
+				T lanes[sizeof(V) / sizeof(T)];
+				std::memcpy(lanes, &v, sizeof(V));
+				return max(lanes, sizeof(V) / sizeof(T));
+			}
+
+			template<typename T, typename V>
+			T sumLanes(const V& v)
+			{
+				T lanes[sizeof(V) / sizeof(T)];
+				std::memcpy(lanes, &v, sizeof(V));
+				return sum(lanes, sizeof(V) / sizeof(T));
+			}
+
+			// SSE2, which every x86-64 CPU has, and 32 bit builds only use if they're built for it
+			// it has no 32 bit integer min/max or multiply, so those are made out of compares, or left scalar
+			inline __m128i selectSSE2(__m128i mask, __m128i ifSet, __m128i ifClear)
+			{
+				return _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear));
+			}
+
+			inline std::size_t findSSE2(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				const __m128i needle = _mm_set1_epi32(value);
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle)));
+
+					if(mask)
+						return i + __builtin_ctz(mask);
+				}
+
+				return i + find(data + i, n - i, value);
+			}
+
+			inline std::size_t findSSE2(const float* data, std::size_t n, float value)
+			{
+				const __m128 needle = _mm_set1_ps(value);
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+				{
+					const int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), needle));
+
+					if(mask)
+						return i + __builtin_ctz(mask);
+				}
+
+				return i + find(data + i, n - i, value);
+			}
+
+			inline std::size_t countSSE2(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				const __m128i needle = _mm_set1_epi32(value);
+				std::size_t found = 0;
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					found += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle))));
+				}
+
+				return found + count(data + i, n - i, value);
+			}
+
+			inline std::size_t countSSE2(const float* data, std::size_t n, float value)
+			{
+				const __m128 needle = _mm_set1_ps(value);
+				std::size_t found = 0;
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+					found += __builtin_popcount(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), needle)));
+
+				return found + count(data + i, n - i, value);
+			}
+
+			inline std::int32_t minSSE2(const std::int32_t* data, std::size_t n)
+			{
+				if(n < 4)
+					return min(data, n);
+
+				__m128i least = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+				std::size_t i = 4;
+
+				for(; i + 4 <= n; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					least = selectSSE2(_mm_cmplt_epi32(v, least), v, least);
+				}
+
+				const std::int32_t vectors = minLanes<std::int32_t>(least);
+				return i < n ? std::min(vectors, min(data + i, n - i)) : vectors;
+			}
+
+			inline float minSSE2(const float* data, std::size_t n)
+			{
+				if(n < 4)
+					return min(data, n);
+
+				__m128 least = _mm_loadu_ps(data);
+				std::size_t i = 4;
+
+				for(; i + 4 <= n; i += 4)
+					least = _mm_min_ps(_mm_loadu_ps(data + i), least);
+
+				const float vectors = minLanes<float>(least);
+				return i < n ? std::min(vectors, min(data + i, n - i)) : vectors;
+			}
+
+			inline std::int32_t maxSSE2(const std::int32_t* data, std::size_t n)
+			{
+				if(n < 4)
+					return max(data, n);
+
+				__m128i most = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+				std::size_t i = 4;
+
+				for(; i + 4 <= n; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					most = selectSSE2(_mm_cmpgt_epi32(v, most), v, most);
+				}
+
+				const std::int32_t vectors = maxLanes<std::int32_t>(most);
+				return i < n ? std::max(vectors, max(data + i, n - i)) : vectors;
+			}
+
+			inline float maxSSE2(const float* data, std::size_t n)
+			{
+				if(n < 4)
+					return max(data, n);
+
+				__m128 most = _mm_loadu_ps(data);
+				std::size_t i = 4;
+
+				for(; i + 4 <= n; i += 4)
+					most = _mm_max_ps(_mm_loadu_ps(data + i), most);
+
+				const float vectors = maxLanes<float>(most);
+				return i < n ? std::max(vectors, max(data + i, n - i)) : vectors;
+			}
+
+			inline std::int32_t sumSSE2(const std::int32_t* data, std::size_t n)
+			{
+				__m128i total = _mm_setzero_si128();
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+					total = _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+
+				return static_cast<std::int32_t>(static_cast<std::uint32_t>(sumLanes<std::int32_t>(total)) + static_cast<std::uint32_t>(sum(data + i, n - i)));
+			}
+
+			inline float sumSSE2(const float* data, std::size_t n)
+			{
+				__m128 total = _mm_setzero_ps();
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+					total = _mm_add_ps(total, _mm_loadu_ps(data + i));
+
+				return sumLanes<float>(total) + sum(data + i, n - i);
+			}
+
+			inline float dotSSE2(const float* lhs, const float* rhs, std::size_t n)
+			{
+				__m128 total = _mm_setzero_ps();
+				std::size_t i = 0;
+
+				for(; i + 4 <= n; i += 4)
+					total = _mm_add_ps(total, _mm_mul_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i)));
+
+				return sumLanes<float>(total) + dot(lhs + i, rhs + i, n - i);
+			}
+
+			// AVX2, same kernels, twice as wide (and with integer min/max/multiply)
+			DBR_SIMD_AVX2 inline std::size_t findAVX2(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				const __m256i needle = _mm256_set1_epi32(value);
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+
+					if(mask)
+						return i + __builtin_ctz(mask);
+				}
+
+				return i + find(data + i, n - i, value);
+			}
+
+			DBR_SIMD_AVX2 inline std::size_t findAVX2(const float* data, std::size_t n, float value)
+			{
+				const __m256 needle = _mm256_set1_ps(value);
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+				{
+					const int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), needle, _CMP_EQ_OQ));
+
+					if(mask)
+						return i + __builtin_ctz(mask);
+				}
+
+				return i + find(data + i, n - i, value);
+			}
+
+			DBR_SIMD_AVX2 inline std::size_t countAVX2(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				const __m256i needle = _mm256_set1_epi32(value);
+				std::size_t found = 0;
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					found += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle))));
+				}
+
+				return found + count(data + i, n - i, value);
+			}
+
+			DBR_SIMD_AVX2 inline std::size_t countAVX2(const float* data, std::size_t n, float value)
+			{
+				const __m256 needle = _mm256_set1_ps(value);
+				std::size_t found = 0;
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+					found += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), needle, _CMP_EQ_OQ)));
+
+				return found + count(data + i, n - i, value);
+			}
+
+			DBR_SIMD_AVX2 inline std::int32_t minAVX2(const std::int32_t* data, std::size_t n)
+			{
+				if(n < 8)
+					return min(data, n);
+
+				__m256i least = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+				std::size_t i = 8;
+
+				for(; i + 8 <= n; i += 8)
+					least = _mm256_min_epi32(least, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+
+				const std::int32_t vectors = minLanes<std::int32_t>(least);
+				return i < n ? std::min(vectors, min(data + i, n - i)) : vectors;
+			}
+
+			DBR_SIMD_AVX2 inline float minAVX2(const float* data, std::size_t n)
+			{
+				if(n < 8)
+					return min(data, n);
+
+				__m256 least = _mm256_loadu_ps(data);
+				std::size_t i = 8;
+
+				for(; i + 8 <= n; i += 8)
+					least = _mm256_min_ps(_mm256_loadu_ps(data + i), least);
+
+				const float vectors = minLanes<float>(least);
+				return i < n ? std::min(vectors, min(data + i, n - i)) : vectors;
+			}
+
+			DBR_SIMD_AVX2 inline std::int32_t maxAVX2(const std::int32_t* data, std::size_t n)
+			{
+				if(n < 8)
+					return max(data, n);
+
+				__m256i most = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+				std::size_t i = 8;
+
+				for(; i + 8 <= n; i += 8)
+					most = _mm256_max_epi32(most, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+
+				const std::int32_t vectors = maxLanes<std::int32_t>(most);
+				return i < n ? std::max(vectors, max(data + i, n - i)) : vectors;
+			}
+
+			DBR_SIMD_AVX2 inline float maxAVX2(const float* data, std::size_t n)
+			{
+				if(n < 8)
+					return max(data, n);
+
+				__m256 most = _mm256_loadu_ps(data);
+				std::size_t i = 8;
+
+				for(; i + 8 <= n; i += 8)
+					most = _mm256_max_ps(_mm256_loadu_ps(data + i), most);
+
+				const float vectors = maxLanes<float>(most);
+				return i < n ? std::max(vectors, max(data + i, n - i)) : vectors;
+			}
+
+			DBR_SIMD_AVX2 inline std::int32_t sumAVX2(const std::int32_t* data, std::size_t n)
+			{
+				__m256i total = _mm256_setzero_si256();
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+					total = _mm256_add_epi32(total, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+
+				return static_cast<std::int32_t>(static_cast<std::uint32_t>(sumLanes<std::int32_t>(total)) + static_cast<std::uint32_t>(sum(data + i, n - i)));
+			}
+
+			DBR_SIMD_AVX2 inline float sumAVX2(const float* data, std::size_t n)
+			{
+				__m256 total = _mm256_setzero_ps();
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+					total = _mm256_add_ps(total, _mm256_loadu_ps(data + i));
+
+				return sumLanes<float>(total) + sum(data + i, n - i);
+			}
+
+			DBR_SIMD_AVX2 inline std::int32_t dotAVX2(const std::int32_t* lhs, const std::int32_t* rhs, std::size_t n)
+			{
+				__m256i total = _mm256_setzero_si256();
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+				{
+					const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+					const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+					total = _mm256_add_epi32(total, _mm256_mullo_epi32(l, r));
+				}
+
+				return static_cast<std::int32_t>(static_cast<std::uint32_t>(sumLanes<std::int32_t>(total)) + static_cast<std::uint32_t>(dot(lhs + i, rhs + i, n - i)));
+			}
+
+			DBR_SIMD_AVX2 inline float dotAVX2(const float* lhs, const float* rhs, std::size_t n)
+			{
+				__m256 total = _mm256_setzero_ps();
+				std::size_t i = 0;
+
+				for(; i + 8 <= n; i += 8)
+					total = _mm256_add_ps(total, _mm256_mul_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i)));
+
+				return sumLanes<float>(total) + dot(lhs + i, rhs + i, n - i);
+			}
+
+			// the vectorized types pick a kernel, over the scalar templates above
+			inline std::size_t find(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				return hasAVX2() ? findAVX2(data, n, value) : findSSE2(data, n, value);
+			}
+
+			inline std::size_t find(const float* data, std::size_t n, float value)
+			{
+				return hasAVX2() ? findAVX2(data, n, value) : findSSE2(data, n, value);
+			}
+
+			inline std::size_t count(const std::int32_t* data, std::size_t n, std::int32_t value)
+			{
+				return hasAVX2() ? countAVX2(data, n, value) : countSSE2(data, n, value);
+			}
+
+			inline std::size_t count(const float* data, std::size_t n, float value)
+			{
+				return hasAVX2() ? countAVX2(data, n, value) : countSSE2(data, n, value);
+			}
+
+			inline std::int32_t min(const std::int32_t* data, std::size_t n)
+			{
+				return hasAVX2() ? minAVX2(data, n) : minSSE2(data, n);
+			}
+
+			inline float min(const float* data, std::size_t n)
+			{
+				return hasAVX2() ? minAVX2(data, n) : minSSE2(data, n);
+			}
+
+			inline std::int32_t max(const std::int32_t* data, std::size_t n)
+			{
+				return hasAVX2() ? maxAVX2(data, n) : maxSSE2(data, n);
+			}
+
+			inline float max(const float* data, std::size_t n)
+			{
+				return hasAVX2() ? maxAVX2(data, n) : maxSSE2(data, n);
+			}
+
+			inline std::int32_t sum(const std::int32_t* data, std::size_t n)
+			{
+				return hasAVX2() ? sumAVX2(data, n) : sumSSE2(data, n);
+			}
+
+			inline float sum(const float* data, std::size_t n)
+			{
+				return hasAVX2() ? sumAVX2(data, n) : sumSSE2(data, n);
+			}
+
+			inline std::int32_t dot(const std::int32_t* lhs, const std::int32_t* rhs, std::size_t n)
+			{
+				return hasAVX2() ? dotAVX2(lhs, rhs, n) : dot<std::int32_t>(lhs, rhs, n);
+			}
+
+			inline float dot(const float* lhs, const float* rhs, std::size_t n)
+			{
+				return hasAVX2() ? dotAVX2(lhs, rhs, n) : dotSSE2(lhs, rhs, n);
+			}
+#endif
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		typename DynArray<T, Alloc, Growth, Observer>::const_iterator find(const DynArray<T, Alloc, Growth, Observer>& array, T value)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			return array.cbegin() + impl::find(array.data(), array.size(), value);
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		std::size_t count(const DynArray<T, Alloc, Growth, Observer>& array, T value)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			return impl::count(array.data(), array.size(), value);
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T min(const DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			if(array.empty())
+				throw std::invalid_argument("dbr::simd::min of an empty array");
+
+			return impl::min(array.data(), array.size());
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T max(const DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			if(array.empty())
+				throw std::invalid_argument("dbr::simd::max of an empty array");
+
+			return impl::max(array.data(), array.size());
+		}
+
+		template<typename T, typename Alloc, typename Growth, typename Observer>
+		T sum(const DynArray<T, Alloc, Growth, Observer>& array)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			return impl::sum(array.data(), array.size());
+		}
+
+		template<typename T, typename A, typename G, typename O, typename B, typename H, typename P>
+		T dot(const DynArray<T, A, G, O>& lhs, const DynArray<T, B, H, P>& rhs)
+		{
+			static_assert(std::is_arithmetic<T>::value, "dbr::simd algorithms are only for arithmetic types");
+
+			if(lhs.size() != rhs.size())
+				throw std::invalid_argument("dbr::simd::dot of different sized arrays");
+
+			return impl::dot(lhs.data(), rhs.data(), lhs.size());
+		}
+	}
+}
+
+#endif
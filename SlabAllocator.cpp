@@ -0,0 +1,327 @@
+#include "SlabAllocator.hpp"
+
+#include <sys/mman.h>
+
+#include "BitOps.hpp"
+
+namespace
+{
+	constexpr std::size_t bitsPerWord = 64;
+
+	// every 16 bytes up to here, then 4 classes per doubling
+	constexpr std::size_t linearClasses = 8;
+	constexpr std::size_t linearLimit = 128;
+
+	constexpr std::size_t sizeOfClass(std::size_t sizeClass)
+	{
+		return sizeClass < linearClasses
+			? 16 * (sizeClass + 1)
+			: (linearLimit << ((sizeClass - linearClasses) / 4)) * (4 + (sizeClass - linearClasses) % 4 + 1) / 4;
+	}
+
+	std::size_t roundUp(std::size_t n, std::size_t multiple)
+	{
+		return (n + multiple - 1) / multiple * multiple;
+	}
+
+	// a slabSize aligned mapping of slabSize bytes
+	// mmap only promises page alignment, so twice as much is mapped, and the parts on either side of an aligned slab unmapped
+	void* mapSlab()
+	{
+		const std::size_t size = swift::SlabHeap::slabSize;
+
+		void* mapped = mmap(nullptr, size * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(mapped == MAP_FAILED)
+			throw std::bad_alloc();
+
+		char* begin = static_cast<char*>(mapped);
+		char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<std::uintptr_t>(begin), size));
+
+		if(aligned != begin)
+			munmap(begin, aligned - begin);
+
+		munmap(aligned + size, begin + size * 2 - (aligned + size));
+
+		return aligned;
+	}
+}
+
+namespace swift
+{
+	constexpr std::size_t SlabHeap::slabSize;
+	constexpr std::size_t SlabHeap::maxSmallSize;
+	constexpr std::size_t SlabHeap::sizeClassCount;
+
+	static_assert(sizeOfClass(SlabHeap::sizeClassCount - 1) == SlabHeap::maxSmallSize, "SlabHeap's size classes don't add up to maxSmallSize");
+
+	double SlabHeap::Stats::internalFragmentation() const
+	{
+		return allocatedBytes ? static_cast<double>(allocatedBytes - requestedBytes) / allocatedBytes : 0.0;
+	}
+
+	double SlabHeap::Stats::externalFragmentation() const
+	{
+		return slabBytes ? static_cast<double>(slabBytes - allocatedBytes) / slabBytes : 0.0;
+	}
+
+	std::uint64_t* SlabHeap::Slab::bitmap()
+	{
+		return reinterpret_cast<std::uint64_t*>(this + 1);
+	}
+
+	SlabHeap::SlabHeap()
+	:	requestedBytes(0),
+		largeBytes(0),
+		largeAllocations(0)
+	{
+		for(std::size_t c = 0; c < sizeClassCount; ++c)
+		{
+			SizeClass& sizeClass = classes[c];
+			sizeClass.blockSize = sizeOfClass(c);
+
+			// as many blocks as fit after the header and their bitmap
+			std::size_t capacity = (slabSize - sizeof(Slab)) / sizeClass.blockSize;
+			std::size_t offset = 0;
+
+			for(;; --capacity)
+			{
+				const std::size_t words = (capacity + bitsPerWord - 1) / bitsPerWord;
+				offset = roundUp(sizeof(Slab) + words * sizeof(std::uint64_t), alignof(std::max_align_t));
+
+				if(offset + capacity * sizeClass.blockSize <= slabSize)
+					break;
+			}
+
+			sizeClass.capacity = capacity;
+			sizeClass.bitmapWords = (capacity + bitsPerWord - 1) / bitsPerWord;
+			sizeClass.blocksOffset = offset;
+
+			sizeClass.partial = nullptr;
+			sizeClass.full = nullptr;
+			sizeClass.empty = nullptr;
+
+			sizeClass.slabs = 0;
+			sizeClass.usedBlocks = 0;
+		}
+	}
+
+	SlabHeap::~SlabHeap()
+	{
+		for(auto& sizeClass : classes)
+		{
+			while(sizeClass.partial)
+			{
+				Slab* slab = sizeClass.partial;
+				unlink(sizeClass.partial, slab);
+				releaseSlab(slab);
+			}
+
+			while(sizeClass.full)
+			{
+				Slab* slab = sizeClass.full;
+				unlink(sizeClass.full, slab);
+				releaseSlab(slab);
+			}
+
+			if(sizeClass.empty)
+				releaseSlab(sizeClass.empty);
+		}
+	}
+
+	void* SlabHeap::allocate(std::size_t bytes)
+	{
+		if(bytes > maxSmallSize)
+		{
+			void* ptr = ::operator new(bytes);
+
+			largeBytes += bytes;
+			++largeAllocations;
+
+			return ptr;
+		}
+
+		const std::size_t c = classOf(bytes);
+		SizeClass& sizeClass = classes[c];
+
+		Slab* slab = sizeClass.partial;
+
+		if(!slab)
+		{
+			if(sizeClass.empty)
+			{
+				slab = sizeClass.empty;
+				sizeClass.empty = nullptr;
+			}
+			else
+			{
+				slab = newSlab(c);
+			}
+
+			pushFront(sizeClass.partial, slab);
+		}
+
+		// there's a free block somewhere, and every word before the hint is full
+		std::uint64_t* bitmap = slab->bitmap();
+
+		std::size_t word = slab->hint;
+		while(bitmap[word] == ~std::uint64_t(0))
+			++word;
+
+		const std::size_t bit = dbr::impl::lowestBit(~bitmap[word]);
+		bitmap[word] |= std::uint64_t(1) << bit;
+		slab->hint = static_cast<std::uint32_t>(word);
+
+		++slab->used;
+		++sizeClass.usedBlocks;
+		requestedBytes += bytes;
+
+		if(slab->used == sizeClass.capacity)
+		{
+			unlink(sizeClass.partial, slab);
+			pushFront(sizeClass.full, slab);
+		}
+
+		return reinterpret_cast<char*>(slab) + sizeClass.blocksOffset + (word * bitsPerWord + bit) * sizeClass.blockSize;
+	}
+
+	void SlabHeap::deallocate(void* ptr, std::size_t bytes)
+	{
+		if(!ptr)
+			return;
+
+		if(bytes > maxSmallSize)
+		{
+			::operator delete(ptr);
+
+			largeBytes -= bytes;
+			--largeAllocations;
+
+			return;
+		}
+
+		// slabs are aligned to their size, so any block's slab is its address rounded down
+		Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(slabSize - 1));
+		SizeClass& sizeClass = classes[slab->sizeClass];
+
+		const std::size_t index = (static_cast<char*>(ptr) - reinterpret_cast<char*>(slab) - sizeClass.blocksOffset) / sizeClass.blockSize;
+		const std::size_t word = index / bitsPerWord;
+
+		slab->bitmap()[word] &= ~(std::uint64_t(1) << (index % bitsPerWord));
+
+		if(word < slab->hint)
+			slab->hint = static_cast<std::uint32_t>(word);
+
+		if(slab->used == sizeClass.capacity)
+		{
+			unlink(sizeClass.full, slab);
+			pushFront(sizeClass.partial, slab);
+		}
+
+		--slab->used;
+		--sizeClass.usedBlocks;
+		requestedBytes -= bytes;
+
+		if(slab->used == 0)
+		{
+			unlink(sizeClass.partial, slab);
+
+			if(sizeClass.empty)
+				releaseSlab(slab);
+			else
+				sizeClass.empty = slab;
+		}
+	}
+
+	std::size_t SlabHeap::blockSize(std::size_t bytes)
+	{
+		return bytes > maxSmallSize ? bytes : sizeOfClass(classOf(bytes));
+	}
+
+	SlabHeap::Stats SlabHeap::stats() const
+	{
+		Stats total = {};
+		total.requestedBytes = requestedBytes;
+		total.largeBytes = largeBytes;
+		total.largeAllocations = largeAllocations;
+
+		for(const auto& sizeClass : classes)
+		{
+			total.allocatedBytes += sizeClass.usedBlocks * sizeClass.blockSize;
+			total.slabBytes += sizeClass.slabs * slabSize;
+			total.slabs += sizeClass.slabs;
+		}
+
+		return total;
+	}
+
+	SlabHeap::ClassStats SlabHeap::classStats(std::size_t c) const
+	{
+		const SizeClass& sizeClass = classes[c];
+		return {sizeClass.blockSize, sizeClass.slabs, sizeClass.usedBlocks, sizeClass.slabs * sizeClass.capacity};
+	}
+
+	std::size_t SlabHeap::classOf(std::size_t bytes)
+	{
+		if(bytes <= linearLimit)
+			return bytes == 0 ? 0 : (bytes + 15) / 16 - 1;
+
+		// "bytes" is in (pow2, pow2 * 2], which is split into 4 classes
+		const std::size_t log2 = dbr::impl::highestBit(bytes - 1);
+		const std::size_t pow2 = std::size_t(1) << log2;
+		const std::size_t step = pow2 / 4;
+
+		return linearClasses + (log2 - 7) * 4 + (bytes - pow2 + step - 1) / step - 1;
+	}
+
+	SlabHeap::Slab* SlabHeap::newSlab(std::size_t c)
+	{
+		SizeClass& sizeClass = classes[c];
+
+		// fresh mappings are zeroed, so the header's the only thing to set up, besides the bitmap's unused bits
+		Slab* slab = static_cast<Slab*>(mapSlab());
+		slab->prev = nullptr;
+		slab->next = nullptr;
+		slab->sizeClass = static_cast<std::uint32_t>(c);
+		slab->used = 0;
+		slab->hint = 0;
+
+		// bits past the last block are marked used, so they're never handed out
+		const std::size_t tail = sizeClass.capacity % bitsPerWord;
+		if(tail != 0)
+			slab->bitmap()[sizeClass.bitmapWords - 1] = ~std::uint64_t(0) << tail;
+
+		++sizeClass.slabs;
+		return slab;
+	}
+
+	void SlabHeap::releaseSlab(Slab* slab)
+	{
+		--classes[slab->sizeClass].slabs;
+		munmap(slab, slabSize);
+	}
+
+	void SlabHeap::unlink(Slab*& list, Slab* slab)
+	{
+		if(slab->prev)
+			slab->prev->next = slab->next;
+		else
+			list = slab->next;
+
+		if(slab->next)
+			slab->next->prev = slab->prev;
+
+		slab->prev = nullptr;
+		slab->next = nullptr;
+	}
+
+	void SlabHeap::pushFront(Slab*& list, Slab* slab)
+	{
+		slab->prev = nullptr;
+		slab->next = list;
+
+		if(list)
+			list->prev = slab;
+
+		list = slab;
+	}
+}
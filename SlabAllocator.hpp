@@ -0,0 +1,245 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace swift
+{
+	// a heap for lots of small objects of mixed sizes
+	// requests are rounded up to a size class: every 16 bytes up to 128, then 4 classes per doubling up to maxSmallSize,
+	// so rounding wastes at most 25% or so. Each class allocates from slabs: slabSize aligned chunks of memory mapped
+	// straight from the OS, with a bitmap of which of their blocks are in use
+	// blocks are handed out lowest address first, so untouched pages stay untouched (and not resident),
+	// and a slab that empties out is given back to the OS (one empty slab per class is kept, to not thrash)
+	// requests over maxSmallSize bypass the slabs and go to ::operator new
+	// blocks are aligned to alignof(std::max_align_t). Not thread safe
+	class SlabHeap
+	{
+		public:
+			static constexpr std::size_t slabSize = 128 * 1024;
+			static constexpr std::size_t maxSmallSize = 16 * 1024;
+			static constexpr std::size_t sizeClassCount = 36;
+
+			struct ClassStats
+			{
+				std::size_t blockSize;
+
+				// slabs held (including an empty one kept around), and blocks in use out of how many they have
+				std::size_t slabs;
+				std::size_t usedBlocks;
+				std::size_t capacityBlocks;
+			};
+
+			struct Stats
+			{
+				// what callers asked for, and what they were given after rounding up to a size class (small requests only)
+				std::size_t requestedBytes;
+				std::size_t allocatedBytes;
+
+				// memory mapped for slabs
+				std::size_t slabBytes;
+				std::size_t slabs;
+
+				// requests that bypassed the slabs
+				std::size_t largeBytes;
+				std::size_t largeAllocations;
+
+				// the fraction of allocatedBytes lost to rounding up to size classes
+				double internalFragmentation() const;
+
+				// the fraction of slabBytes that isn't allocated: free blocks, headers, and slack at the ends of slabs
+				double externalFragmentation() const;
+			};
+
+			SlabHeap();
+
+			SlabHeap(const SlabHeap&) = delete;
+			SlabHeap& operator =(const SlabHeap&) = delete;
+
+			// the slabs are given back, and everything in them with them. Large allocations have to be freed before
+			~SlabHeap();
+
+			// throws std::bad_alloc
+			void* allocate(std::size_t bytes);
+
+			// "bytes" has to be what the block was allocated with
+			void deallocate(void* ptr, std::size_t bytes);
+
+			// how many bytes a request for "bytes" actually gets
+			static std::size_t blockSize(std::size_t bytes);
+
+			Stats stats() const;
+			ClassStats classStats(std::size_t sizeClass) const;
+
+		private:
+			// at the start of every slab, followed by the bitmap, then the blocks
+			struct Slab
+			{
+				// in its class's list of partially used (or full) slabs
+				Slab* prev;
+				Slab* next;
+
+				std::uint32_t sizeClass;
+				std::uint32_t used;
+
+				// where to start looking for a free block: every word before it is full
+				std::uint32_t hint;
+
+				std::uint64_t* bitmap();
+			};
+
+			struct SizeClass
+			{
+				std::size_t blockSize;
+				std::size_t capacity;
+				std::size_t bitmapWords;
+
+				// where the blocks start in a slab
+				std::size_t blocksOffset;
+
+				// slabs with free blocks, and those without
+				Slab* partial;
+				Slab* full;
+
+				// kept when it empties, rather than given back right away
+				Slab* empty;
+
+				std::size_t slabs;
+				std::size_t usedBlocks;
+			};
+
+			static std::size_t classOf(std::size_t bytes);
+
+			Slab* newSlab(std::size_t sizeClass);
+			void releaseSlab(Slab*);
+
+			static void unlink(Slab*& list, Slab*);
+			static void pushFront(Slab*& list, Slab*);
+
+			SizeClass classes[sizeClassCount];
+
+			std::size_t requestedBytes;
+			std::size_t largeBytes;
+			std::size_t largeAllocations;
+	};
+
+	// a SlabHeap, typed, for containers' Alloc parameter (ie: DynArray<T, swift::SlabAllocator<T>>)
+	// copies share the same heap, which has to outlive everything allocated from it
+	template<typename T>
+	class SlabAllocator
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "SlabAllocator can't over-align blocks");
+
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			struct allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+			template<typename U>
+			struct rebind
+			{
+				using other = SlabAllocator<U>;
+			};
+
+			SlabAllocator(SlabHeap& heap);
+
+			template<typename U>
+			SlabAllocator(const SlabAllocator<U>& other);
+
+			pointer allocate(size_type n);
+
+			// the rest of the size class is counted too
+			allocation_result allocate_at_least(size_type n);
+
+			void deallocate(pointer ptr, size_type n);
+
+			SlabHeap& heap() const;
+
+			template<typename U, typename V>
+			friend bool operator ==(const SlabAllocator<U>&, const SlabAllocator<V>&);
+
+			template<typename U, typename V>
+			friend bool operator !=(const SlabAllocator<U>&, const SlabAllocator<V>&);
+
+		private:
+			template<typename U>
+			friend class SlabAllocator;
+
+			static size_type bytesFor(size_type n);
+
+			SlabHeap* owner;
+	};
+
+	template<typename T>
+	SlabAllocator<T>::SlabAllocator(SlabHeap& heap)
+	:	owner(&heap)
+	{}
+
+	template<typename T>
+	template<typename U>
+	SlabAllocator<T>::SlabAllocator(const SlabAllocator<U>& other)
+	:	owner(other.owner)
+	{}
+
+	template<typename T>
+	typename SlabAllocator<T>::pointer SlabAllocator<T>::allocate(size_type n)
+	{
+		return static_cast<pointer>(owner->allocate(bytesFor(n)));
+	}
+
+	template<typename T>
+	typename SlabAllocator<T>::allocation_result SlabAllocator<T>::allocate_at_least(size_type n)
+	{
+		// asked for as a whole number of Ts, so deallocate() gives back the same number of bytes
+		const size_type count = SlabHeap::blockSize(bytesFor(n)) / sizeof(T);
+		return {allocate(count), count};
+	}
+
+	template<typename T>
+	void SlabAllocator<T>::deallocate(pointer ptr, size_type n)
+	{
+		owner->deallocate(ptr, n * sizeof(T));
+	}
+
+	template<typename T>
+	SlabHeap& SlabAllocator<T>::heap() const
+	{
+		return *owner;
+	}
+
+	template<typename T>
+	typename SlabAllocator<T>::size_type SlabAllocator<T>::bytesFor(size_type n)
+	{
+		if(n > std::numeric_limits<size_type>::max() / sizeof(T))
+			throw std::bad_alloc();
+
+		return n * sizeof(T);
+	}
+
+	template<typename U, typename V>
+	bool operator ==(const SlabAllocator<U>& lhs, const SlabAllocator<V>& rhs)
+	{
+		return lhs.owner == rhs.owner;
+	}
+
+	template<typename U, typename V>
+	bool operator !=(const SlabAllocator<U>& lhs, const SlabAllocator<V>& rhs)
+	{
+		return lhs.owner != rhs.owner;
+	}
+}
+
+#endif
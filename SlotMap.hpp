@@ -0,0 +1,398 @@
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "DynArray.hpp"
+
+// hands out 32 bit handles to its elements instead of pointers, so nothing has to be told when the elements move
+// a handle is a slot index plus the slot's generation, which changes every time the slot is reused,
+// so a handle to an erased element is detected as stale rather than finding whatever took its place
+// the elements themselves are kept densely packed in a DynArray (erasing moves the last one into the gap),
+// so iterating over them is a plain walk over contiguous memory, no matter how much churn there's been
+// insert, erase, and lookup are all O(1)
+// IndexBits of a handle are the slot, the rest are the generation. A slot is retired once its generation runs out
+template<typename T, std::size_t IndexBits = 20>
+class SlotMap
+{
+	static_assert(IndexBits > 0 && IndexBits < 32, "SlotMap handles need room for both an index and a generation");
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using iterator = typename DynArray<T>::iterator;
+		using const_iterator = typename DynArray<T>::const_iterator;
+
+		class Handle
+		{
+			public:
+				// a handle to nothing, never valid
+				Handle();
+
+				std::uint32_t index() const;
+				std::uint32_t generation() const;
+
+				// for storing it somewhere as a plain number
+				std::uint32_t value() const;
+				static Handle fromValue(std::uint32_t);
+
+				bool operator ==(const Handle&) const;
+				bool operator !=(const Handle&) const;
+
+			private:
+				friend class SlotMap;
+
+				Handle(std::uint32_t index, std::uint32_t generation);
+
+				std::uint32_t bits;
+		};
+
+		// the most elements a SlotMap can have at once
+		static constexpr size_type maxSlots = (size_type(1) << IndexBits) - 1;
+
+		// throws std::length_error if there's no slot left for it
+		template<typename... Args>
+		Handle emplace(Args&&...);
+
+		Handle insert(const T&);
+		Handle insert(T&&);
+
+		// returns false if the handle was already stale
+		bool erase(Handle);
+
+		// nullptr if the handle is stale
+		T* get(Handle);
+		const T* get(Handle) const;
+
+		// throws std::out_of_range if the handle is stale
+		T& at(Handle);
+		const T& at(Handle) const;
+
+		bool contains(Handle) const;
+
+		void clear();
+		void reserve(size_type);
+
+		// the elements, densely packed, in no particular order
+		iterator begin();
+		const_iterator begin() const;
+
+		iterator end();
+		const_iterator end() const;
+
+		T* data();
+		const T* data() const;
+
+		// the handle of the element at data()[i]
+		Handle handleAt(size_type) const;
+
+		size_type size() const;
+		bool empty() const;
+
+	private:
+		static constexpr std::uint32_t indexMask = (std::uint32_t(1) << IndexBits) - 1;
+		static constexpr std::uint32_t maxGeneration = (std::uint32_t(1) << (32 - IndexBits)) - 1;
+
+		// the end of the free list, and the null handle's index (never a real slot)
+		static constexpr std::uint32_t none = indexMask;
+
+		struct Slot
+		{
+			// where the element is in "values", or the next free slot if this one is free
+			std::uint32_t place;
+
+			// odd while in use, even while free
+			std::uint32_t generation;
+		};
+
+		// the slot a handle points to, if it isn't stale
+		const Slot* find(Handle) const;
+
+		DynArray<T> values;
+
+		// the slot each element in "values" belongs to
+		DynArray<std::uint32_t> owners;
+
+		DynArray<Slot> slots;
+		std::uint32_t freeHead = none;
+};
+
+// Handle
+template<typename T, std::size_t IndexBits>
+SlotMap<T, IndexBits>::Handle::Handle()
+:	bits(none)
+{}
+
+template<typename T, std::size_t IndexBits>
+SlotMap<T, IndexBits>::Handle::Handle(std::uint32_t index, std::uint32_t generation)
+:	bits(generation << IndexBits | index)
+{}
+
+template<typename T, std::size_t IndexBits>
+std::uint32_t SlotMap<T, IndexBits>::Handle::index() const
+{
+	return bits & indexMask;
+}
+
+template<typename T, std::size_t IndexBits>
+std::uint32_t SlotMap<T, IndexBits>::Handle::generation() const
+{
+	return bits >> IndexBits;
+}
+
+template<typename T, std::size_t IndexBits>
+std::uint32_t SlotMap<T, IndexBits>::Handle::value() const
+{
+	return bits;
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::Handle SlotMap<T, IndexBits>::Handle::fromValue(std::uint32_t value)
+{
+	Handle handle;
+	handle.bits = value;
+	return handle;
+}
+
+template<typename T, std::size_t IndexBits>
+bool SlotMap<T, IndexBits>::Handle::operator ==(const Handle& other) const
+{
+	return bits == other.bits;
+}
+
+template<typename T, std::size_t IndexBits>
+bool SlotMap<T, IndexBits>::Handle::operator !=(const Handle& other) const
+{
+	return bits != other.bits;
+}
+
+// SlotMap
+template<typename T, std::size_t IndexBits>
+template<typename... Args>
+typename SlotMap<T, IndexBits>::Handle SlotMap<T, IndexBits>::emplace(Args&&... args)
+{
+	if(freeHead == none && slots.size() == maxSlots)
+		throw std::length_error("SlotMap is out of slots");
+
+	const std::uint32_t place = static_cast<std::uint32_t>(values.size());
+
+	// reuse a free slot if there is one
+	const bool fresh = freeHead == none;
+	const std::uint32_t index = fresh ? static_cast<std::uint32_t>(slots.size()) : freeHead;
+
+	if(fresh)
+		slots.push_back({none, 0});
+
+	// if anything throws, undo what's been done so far
+	try
+	{
+		owners.push_back(index);
+
+		try
+		{
+			values.emplace_back(std::forward<Args>(args)...);
+		}
+		catch(...)
+		{
+			owners.pop_back();
+			throw;
+		}
+	}
+	catch(...)
+	{
+		if(fresh)
+			slots.pop_back();
+
+		throw;
+	}
+
+	if(!fresh)
+		freeHead = slots[index].place;
+
+	Slot& slot = slots[index];
+	slot.place = place;
+	++slot.generation;
+
+	return {index, slot.generation};
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::Handle SlotMap<T, IndexBits>::insert(const T& value)
+{
+	return emplace(value);
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::Handle SlotMap<T, IndexBits>::insert(T&& value)
+{
+	return emplace(std::move(value));
+}
+
+template<typename T, std::size_t IndexBits>
+bool SlotMap<T, IndexBits>::erase(Handle handle)
+{
+	if(!find(handle))
+		return false;
+
+	Slot& slot = slots[handle.index()];
+	const std::uint32_t place = slot.place;
+	const std::uint32_t last = static_cast<std::uint32_t>(values.size() - 1);
+
+	// fill the gap with the last element, so they stay packed
+	values.swap_erase(values.cbegin() + place);
+	owners.swap_erase(owners.cbegin() + place);
+
+	if(place != last)
+		slots[owners[place]].place = place;
+
+	++slot.generation;
+
+	// once a slot has used up its generations, reusing it could make an old handle valid again, so it's retired
+	if(slot.generation < maxGeneration)
+	{
+		slot.place = freeHead;
+		freeHead = handle.index();
+	}
+
+	return true;
+}
+
+template<typename T, std::size_t IndexBits>
+T* SlotMap<T, IndexBits>::get(Handle handle)
+{
+	const Slot* slot = find(handle);
+	return slot ? &values[slot->place] : nullptr;
+}
+
+template<typename T, std::size_t IndexBits>
+const T* SlotMap<T, IndexBits>::get(Handle handle) const
+{
+	const Slot* slot = find(handle);
+	return slot ? &values[slot->place] : nullptr;
+}
+
+template<typename T, std::size_t IndexBits>
+T& SlotMap<T, IndexBits>::at(Handle handle)
+{
+	T* value = get(handle);
+	if(!value)
+		throw std::out_of_range("SlotMap: stale handle");
+
+	return *value;
+}
+
+template<typename T, std::size_t IndexBits>
+const T& SlotMap<T, IndexBits>::at(Handle handle) const
+{
+	const T* value = get(handle);
+	if(!value)
+		throw std::out_of_range("SlotMap: stale handle");
+
+	return *value;
+}
+
+template<typename T, std::size_t IndexBits>
+bool SlotMap<T, IndexBits>::contains(Handle handle) const
+{
+	return find(handle) != nullptr;
+}
+
+template<typename T, std::size_t IndexBits>
+void SlotMap<T, IndexBits>::clear()
+{
+	// every handle out there has to go stale, so the slots are freed rather than forgotten
+	for(size_type i = 0; i < owners.size(); ++i)
+	{
+		Slot& slot = slots[owners[i]];
+		++slot.generation;
+
+		if(slot.generation < maxGeneration)
+		{
+			slot.place = freeHead;
+			freeHead = owners[i];
+		}
+	}
+
+	values.clear();
+	owners.clear();
+}
+
+template<typename T, std::size_t IndexBits>
+void SlotMap<T, IndexBits>::reserve(size_type n)
+{
+	values.reserve(n);
+	owners.reserve(n);
+	slots.reserve(n);
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::iterator SlotMap<T, IndexBits>::begin()
+{
+	return values.begin();
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::const_iterator SlotMap<T, IndexBits>::begin() const
+{
+	return values.begin();
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::iterator SlotMap<T, IndexBits>::end()
+{
+	return values.end();
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::const_iterator SlotMap<T, IndexBits>::end() const
+{
+	return values.end();
+}
+
+template<typename T, std::size_t IndexBits>
+T* SlotMap<T, IndexBits>::data()
+{
+	return values.data();
+}
+
+template<typename T, std::size_t IndexBits>
+const T* SlotMap<T, IndexBits>::data() const
+{
+	return values.data();
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::Handle SlotMap<T, IndexBits>::handleAt(size_type i) const
+{
+	const std::uint32_t index = owners[i];
+	return {index, slots[index].generation};
+}
+
+template<typename T, std::size_t IndexBits>
+typename SlotMap<T, IndexBits>::size_type SlotMap<T, IndexBits>::size() const
+{
+	return values.size();
+}
+
+template<typename T, std::size_t IndexBits>
+bool SlotMap<T, IndexBits>::empty() const
+{
+	return values.empty();
+}
+
+template<typename T, std::size_t IndexBits>
+const typename SlotMap<T, IndexBits>::Slot* SlotMap<T, IndexBits>::find(Handle handle) const
+{
+	const std::uint32_t index = handle.index();
+
+	// in use slots have odd generations, so the null handle (generation 0 at index "none") never matches
+	if(index >= slots.size() || slots[index].generation != handle.generation() || !(handle.generation() & 1))
+		return nullptr;
+
+	return &slots[index];
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef SMALL_DYN_ARRAY_HPP
+#define SMALL_DYN_ARRAY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "DynArray.hpp"
+
+// an allocator with room for N Ts inside of itself
+// the first block asked for that fits is handed out from there, everything else goes to "Alloc"
+// since DynArray keeps its allocator inside of itself, so do its first N elements
+template<typename T, std::size_t N, typename Alloc = std::allocator<T>>
+class InlineAllocator
+{
+	public:
+		using value_type = T;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using difference_type = std::ptrdiff_t;
+		using size_type = std::size_t;
+
+		struct allocation_result
+		{
+			pointer ptr;
+			size_type count;
+		};
+
+		template<typename U>
+		struct rebind
+		{
+			using other = InlineAllocator<U, N, typename std::allocator_traits<Alloc>::template rebind_alloc<U>>;
+		};
+
+		InlineAllocator();
+
+		// the buffer belongs to this allocator, so copies only get the fallback
+		InlineAllocator(const InlineAllocator&);
+		InlineAllocator& operator =(const InlineAllocator&);
+
+		// rebinding, which likewise only gets the fallback (rebound to Ts)
+		template<typename U, typename A>
+		InlineAllocator(const InlineAllocator<U, N, A>&);
+
+		~InlineAllocator() = default;
+
+		pointer allocate(size_type n);
+		allocation_result allocate_at_least(size_type n);
+		void deallocate(pointer ptr, size_type n);
+
+		// memory handed out by one allocator can only be freed by another if it isn't from the buffer
+		template<typename U, std::size_t M, typename A>
+		friend bool operator ==(const InlineAllocator<U, M, A>&, const InlineAllocator<U, M, A>&);
+
+		template<typename U, std::size_t M, typename A>
+		friend bool operator !=(const InlineAllocator<U, M, A>&, const InlineAllocator<U, M, A>&);
+
+	private:
+		template<typename U, std::size_t M, typename A>
+		friend class InlineAllocator;
+
+		pointer buffer();
+
+		typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+		bool bufferUsed;
+
+		Alloc fallback;
+};
+
+namespace dbr
+{
+	// a block in another InlineAllocator's buffer fits in ours (ours being free, in a DynArray that's being moved into)
+	// a block from the fallback only needs allocating if fallbacks can differ
+	template<typename T, std::size_t N, typename Alloc>
+	struct has_inline_storage<InlineAllocator<T, N, Alloc>> : std::allocator_traits<Alloc>::is_always_equal
+	{};
+}
+
+// a DynArray that keeps its first N elements inside of itself, and only goes to the heap once it outgrows them
+// its first block is asked for with room for exactly N, so it's always the inline one. After that it grows by Growth
+template<typename T, std::size_t N, typename Alloc = std::allocator<T>, typename Growth = dbr::growth::Double>
+using SmallDynArray = DynArray<T, InlineAllocator<T, N, Alloc>, dbr::growth::StartingAt<N, Growth>>;
+
+template<typename T, std::size_t N, typename Alloc>
+InlineAllocator<T, N, Alloc>::InlineAllocator()
+:	bufferUsed(false)
+{}
+
+template<typename T, std::size_t N, typename Alloc>
+InlineAllocator<T, N, Alloc>::InlineAllocator(const InlineAllocator& other)
+:	bufferUsed(false),
+	fallback(other.fallback)
+{}
+
+template<typename T, std::size_t N, typename Alloc>
+template<typename U, typename A>
+InlineAllocator<T, N, Alloc>::InlineAllocator(const InlineAllocator<U, N, A>& other)
+:	bufferUsed(false),
+	fallback(other.fallback)
+{}
+
+template<typename T, std::size_t N, typename Alloc>
+InlineAllocator<T, N, Alloc>& InlineAllocator<T, N, Alloc>::operator =(const InlineAllocator& other)
+{
+	fallback = other.fallback;
+	return *this;
+}
+
+template<typename T, std::size_t N, typename Alloc>
+typename InlineAllocator<T, N, Alloc>::pointer InlineAllocator<T, N, Alloc>::allocate(size_type n)
+{
+	return allocate_at_least(n).ptr;
+}
+
+template<typename T, std::size_t N, typename Alloc>
+typename InlineAllocator<T, N, Alloc>::allocation_result InlineAllocator<T, N, Alloc>::allocate_at_least(size_type n)
+{
+	if(!bufferUsed && n <= N)
+	{
+		bufferUsed = true;
+		return {buffer(), N};
+	}
+
+	return {fallback.allocate(n), n};
+}
+
+template<typename T, std::size_t N, typename Alloc>
+void InlineAllocator<T, N, Alloc>::deallocate(pointer ptr, size_type n)
+{
+	if(ptr == buffer())
+		bufferUsed = false;
+	else
+		fallback.deallocate(ptr, n);
+}
+
+template<typename T, std::size_t N, typename Alloc>
+typename InlineAllocator<T, N, Alloc>::pointer InlineAllocator<T, N, Alloc>::buffer()
+{
+	return reinterpret_cast<pointer>(&storage);
+}
+
+template<typename T, std::size_t N, typename Alloc>
+bool operator ==(const InlineAllocator<T, N, Alloc>& lhs, const InlineAllocator<T, N, Alloc>& rhs)
+{
+	return !lhs.bufferUsed && !rhs.bufferUsed && lhs.fallback == rhs.fallback;
+}
+
+template<typename T, std::size_t N, typename Alloc>
+bool operator !=(const InlineAllocator<T, N, Alloc>& lhs, const InlineAllocator<T, N, Alloc>& rhs)
+{
+	return !(lhs == rhs);
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+namespace dbr
+{
+	// a view of "n" contiguous elements, for handing out part of a container without copying it
+	template<typename T>
+	class Span
+	{
+		public:
+			using value_type = typename std::remove_const<T>::type;
+			using size_type = std::size_t;
+			using iterator = T*;
+
+			Span(T* first, size_type n)
+			:	first(first),
+				n(n)
+			{}
+
+			T* data() const
+			{
+				return first;
+			}
+
+			size_type size() const
+			{
+				return n;
+			}
+
+			bool empty() const
+			{
+				return n == 0;
+			}
+
+			T& operator [](size_type i) const
+			{
+				return first[i];
+			}
+
+			iterator begin() const
+			{
+				return first;
+			}
+
+			iterator end() const
+			{
+				return first + n;
+			}
+
+		private:
+			T* first;
+			size_type n;
+	};
+}
+
+#endif
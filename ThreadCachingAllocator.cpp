@@ -0,0 +1,294 @@
+#include "ThreadCachingAllocator.hpp"
+
+#include <mutex>
+
+#include "BitOps.hpp"
+
+namespace
+{
+	using Heap = swift::ThreadCachingHeap;
+
+	// 16 bytes to 32 KiB, in powers of two
+	constexpr std::size_t classCount = 12;
+
+	static_assert(Heap::minBlockSize << (classCount - 1) == Heap::maxBlockSize, "ThreadCachingHeap size classes don't add up");
+
+	// the depot asks for at least this much at a time
+	constexpr std::size_t slabSize = 256 * 1024;
+
+	std::size_t classOf(std::size_t bytes)
+	{
+		if(bytes <= Heap::minBlockSize)
+			return 0;
+
+		// log2 of "bytes" rounded up to a power of two, less log2 of the smallest class
+		return dbr::impl::highestBit(bytes - 1) + 1 - 4;
+	}
+
+	std::size_t classSize(std::size_t sizeClass)
+	{
+		return Heap::minBlockSize << sizeClass;
+	}
+
+	// free blocks are linked into chains of up to batchSize, and the depot keeps a list of chains
+	// so trading a batch with the depot is one link or unlink under its lock, and the walking happens outside of it
+	// every block has room for both links, since the smallest is 16 bytes
+	struct FreeBlock
+	{
+		FreeBlock* next;
+
+		// only used by the first block of a chain
+		FreeBlock* nextChain;
+	};
+
+	// slabs start with one of these, the blocks follow it
+	struct alignas(std::max_align_t) Slab
+	{
+		Slab* next;
+	};
+
+	class Depot
+	{
+		public:
+			Depot() = default;
+
+			Depot(const Depot&) = delete;
+			Depot& operator =(const Depot&) = delete;
+
+			~Depot();
+
+			// writes batchSize free blocks of "sizeClass" (or fewer, if a thread gave back a short chain) to "out"
+			std::size_t take(std::size_t sizeClass, void** out);
+
+			// "chain" has to be linked already
+			void give(std::size_t sizeClass, FreeBlock* chain);
+
+		private:
+			struct SizeClass
+			{
+				std::mutex lock;
+				FreeBlock* chains = nullptr;
+
+				// the part of the newest slab that's never been handed out
+				char* fresh = nullptr;
+				char* freshEnd = nullptr;
+
+				Slab* slabs = nullptr;
+			};
+
+			SizeClass classes[classCount];
+	};
+
+	Depot::~Depot()
+	{
+		for(auto& sizeClass : classes)
+		{
+			while(sizeClass.slabs)
+			{
+				Slab* next = sizeClass.slabs->next;
+				::operator delete(sizeClass.slabs);
+				sizeClass.slabs = next;
+			}
+		}
+	}
+
+	std::size_t Depot::take(std::size_t sizeClass, void** out)
+	{
+		SizeClass& from = classes[sizeClass];
+		const std::size_t size = classSize(sizeClass);
+
+		FreeBlock* chain = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(from.lock);
+
+			if(from.chains)
+			{
+				chain = from.chains;
+				from.chains = chain->nextChain;
+			}
+			else
+			{
+				if(from.fresh == from.freshEnd)
+				{
+					// always a whole number of batches
+					const std::size_t batchBytes = size * Heap::batchSize;
+					const std::size_t blockBytes = (slabSize + batchBytes - 1) / batchBytes * batchBytes;
+
+					Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab) + blockBytes));
+					slab->next = from.slabs;
+					from.slabs = slab;
+
+					from.fresh = reinterpret_cast<char*>(slab + 1);
+					from.freshEnd = from.fresh + blockBytes;
+				}
+
+				char* first = from.fresh;
+				from.fresh += size * Heap::batchSize;
+
+				for(std::size_t i = 0; i < Heap::batchSize; ++i)
+					out[i] = first + i * size;
+
+				return Heap::batchSize;
+			}
+		}
+
+		std::size_t count = 0;
+		for(; chain; chain = chain->next)
+			out[count++] = chain;
+
+		return count;
+	}
+
+	void Depot::give(std::size_t sizeClass, FreeBlock* chain)
+	{
+		SizeClass& to = classes[sizeClass];
+
+		std::lock_guard<std::mutex> lock(to.lock);
+
+		chain->nextChain = to.chains;
+		to.chains = chain;
+	}
+
+	Depot& depot()
+	{
+		static Depot instance;
+		return instance;
+	}
+
+	// links "blocks" into a chain and gives it to the depot
+	void giveBlocks(std::size_t sizeClass, void** blocks, std::size_t count)
+	{
+		for(std::size_t i = 0; i < count; ++i)
+			static_cast<FreeBlock*>(blocks[i])->next = i + 1 < count ? static_cast<FreeBlock*>(blocks[i + 1]) : nullptr;
+
+		depot().give(sizeClass, static_cast<FreeBlock*>(blocks[0]));
+	}
+
+	// a thread's cache. Plain data, so it's still usable after its thread has started exiting
+	// (ie: by the destructors of other thread_locals), it just stops caching then
+	struct Cache
+	{
+		void* blocks[classCount][Heap::batchSize * 2];
+		std::size_t counts[classCount];
+
+		bool registered;
+		bool exited;
+	};
+
+	thread_local Cache cache;
+
+	void flush()
+	{
+		for(std::size_t c = 0; c < classCount; ++c)
+		{
+			while(cache.counts[c] > 0)
+			{
+				const std::size_t n = cache.counts[c] < Heap::batchSize ? cache.counts[c] : Heap::batchSize;
+
+				cache.counts[c] -= n;
+				giveBlocks(c, cache.blocks[c] + cache.counts[c], n);
+			}
+		}
+	}
+
+	// flushes the cache when its thread exits
+	struct Flusher
+	{
+		~Flusher()
+		{
+			flush();
+			cache.exited = true;
+		}
+	};
+
+	thread_local Flusher flusher;
+}
+
+namespace swift
+{
+	constexpr std::size_t ThreadCachingHeap::minBlockSize;
+	constexpr std::size_t ThreadCachingHeap::maxBlockSize;
+	constexpr std::size_t ThreadCachingHeap::batchSize;
+
+	void* ThreadCachingHeap::allocate(std::size_t bytes)
+	{
+		if(bytes > maxBlockSize)
+			return ::operator new(bytes);
+
+		const std::size_t sizeClass = classOf(bytes);
+		std::size_t& count = cache.counts[sizeClass];
+		void** blocks = cache.blocks[sizeClass];
+
+		if(count == 0)
+		{
+			// using the Flusher is what makes it flush when this thread exits
+			if(!cache.registered)
+			{
+				static_cast<void>(&flusher);
+				cache.registered = true;
+			}
+
+			count = depot().take(sizeClass, blocks);
+
+			// too late to cache anything, keep one and give the rest back
+			if(cache.exited)
+			{
+				void* block = blocks[0];
+
+				if(count > 1)
+					giveBlocks(sizeClass, blocks + 1, count - 1);
+
+				count = 0;
+				return block;
+			}
+		}
+
+		return blocks[--count];
+	}
+
+	void ThreadCachingHeap::deallocate(void* ptr, std::size_t bytes)
+	{
+		if(!ptr)
+			return;
+
+		if(bytes > maxBlockSize)
+		{
+			::operator delete(ptr);
+			return;
+		}
+
+		const std::size_t sizeClass = classOf(bytes);
+		std::size_t& count = cache.counts[sizeClass];
+		void** blocks = cache.blocks[sizeClass];
+
+		if(cache.exited)
+		{
+			giveBlocks(sizeClass, &ptr, 1);
+			return;
+		}
+
+		// full, give the older half back
+		if(count == batchSize * 2)
+		{
+			giveBlocks(sizeClass, blocks, batchSize);
+
+			for(std::size_t i = 0; i < batchSize; ++i)
+				blocks[i] = blocks[i + batchSize];
+
+			count = batchSize;
+		}
+
+		blocks[count++] = ptr;
+	}
+
+	std::size_t ThreadCachingHeap::blockSize(std::size_t bytes)
+	{
+		return bytes > maxBlockSize ? bytes : classSize(classOf(bytes));
+	}
+
+	void ThreadCachingHeap::flushThread()
+	{
+		flush();
+	}
+}
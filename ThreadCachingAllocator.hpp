@@ -0,0 +1,126 @@
+#ifndef THREAD_CACHING_ALLOCATOR_HPP
+#define THREAD_CACHING_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace swift
+{
+	// a heap for small blocks that threads can use at the same time without contending for anything
+	// requests are rounded up to a power of two size class. Each thread keeps a cache of free blocks per class,
+	// and only goes to the shared depot (and its lock) to trade batchSize blocks at a time:
+	// for more when its cache runs dry, or to give some back when it fills up
+	// when a thread exits, everything in its cache goes back to the depot for other threads to use
+	// the depot carves new blocks out of big slabs, which it keeps until the program exits
+	// blocks are aligned to alignof(std::max_align_t). Requests over maxBlockSize go to ::operator new
+	class ThreadCachingHeap
+	{
+		public:
+			static constexpr std::size_t minBlockSize = 16;
+			static constexpr std::size_t maxBlockSize = 32 * 1024;
+			static constexpr std::size_t batchSize = 32;
+
+			static void* allocate(std::size_t bytes);
+
+			// "bytes" has to be what the block was allocated with (or anything else that rounds to the same size class)
+			static void deallocate(void* ptr, std::size_t bytes);
+
+			// how many bytes a request for "bytes" actually gets
+			static std::size_t blockSize(std::size_t bytes);
+
+			// gives the calling thread's cached blocks back to the depot now, rather than when it exits
+			static void flushThread();
+	};
+
+	// ThreadCachingHeap, for containers' Alloc parameter (ie: DynArray<T, swift::ThreadCachingAllocator<T>>)
+	// stateless, so every one is interchangeable with every other one, on any thread
+	template<typename T>
+	class ThreadCachingAllocator
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "ThreadCachingAllocator can't over-align blocks");
+
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			struct allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+			template<typename U>
+			struct rebind
+			{
+				using other = ThreadCachingAllocator<U>;
+			};
+
+			ThreadCachingAllocator() = default;
+
+			template<typename U>
+			ThreadCachingAllocator(const ThreadCachingAllocator<U>&);
+
+			pointer allocate(size_type n);
+
+			// the rest of the size class is counted too
+			allocation_result allocate_at_least(size_type n);
+
+			void deallocate(pointer ptr, size_type n);
+
+		private:
+			static size_type bytesFor(size_type n);
+	};
+
+	template<typename T>
+	template<typename U>
+	ThreadCachingAllocator<T>::ThreadCachingAllocator(const ThreadCachingAllocator<U>&)
+	{}
+
+	template<typename T>
+	typename ThreadCachingAllocator<T>::pointer ThreadCachingAllocator<T>::allocate(size_type n)
+	{
+		return static_cast<pointer>(ThreadCachingHeap::allocate(bytesFor(n)));
+	}
+
+	template<typename T>
+	typename ThreadCachingAllocator<T>::allocation_result ThreadCachingAllocator<T>::allocate_at_least(size_type n)
+	{
+		const size_type bytes = ThreadCachingHeap::blockSize(bytesFor(n));
+		return {static_cast<pointer>(ThreadCachingHeap::allocate(bytes)), bytes / sizeof(T)};
+	}
+
+	template<typename T>
+	void ThreadCachingAllocator<T>::deallocate(pointer ptr, size_type n)
+	{
+		ThreadCachingHeap::deallocate(ptr, n * sizeof(T));
+	}
+
+	template<typename T>
+	typename ThreadCachingAllocator<T>::size_type ThreadCachingAllocator<T>::bytesFor(size_type n)
+	{
+		if(n > std::numeric_limits<size_type>::max() / sizeof(T))
+			throw std::bad_alloc();
+
+		return n * sizeof(T);
+	}
+
+	template<typename T, typename U>
+	bool operator ==(const ThreadCachingAllocator<T>&, const ThreadCachingAllocator<U>&)
+	{
+		return true;
+	}
+
+	template<typename T, typename U>
+	bool operator !=(const ThreadCachingAllocator<T>&, const ThreadCachingAllocator<U>&)
+	{
+		return false;
+	}
+}
+
+#endif
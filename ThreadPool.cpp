@@ -0,0 +1,145 @@
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace
+{
+	// what everyone working on one parallelFor shares
+	// kept alive by whoever still has it, since helpers can get to it after the loop has finished
+	struct Loop
+	{
+		Loop(std::size_t count, const ThreadPool::Task& task)
+		:	task(task),
+			count(count),
+			next(0),
+			done(0)
+		{}
+
+		// runs indices until there are none left
+		void run()
+		{
+			for(std::size_t i = next++; i < count; i = next++)
+			{
+				try
+				{
+					task(i);
+				}
+				catch(...)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if(!error)
+						error = std::current_exception();
+				}
+
+				if(++done == count)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					finished.notify_all();
+				}
+			}
+		}
+
+		// the caller's copy of the task outlives the loop
+		const ThreadPool::Task& task;
+		const std::size_t count;
+
+		std::atomic<std::size_t> next;
+		std::atomic<std::size_t> done;
+
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr error;
+	};
+}
+
+ThreadPool::ThreadPool(std::size_t threads)
+:	stopping(false)
+{
+	if(threads == 0)
+		threads = std::thread::hardware_concurrency();
+
+	// the caller is one of them
+	for(std::size_t i = 1; i < threads; ++i)
+		workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	wake.notify_all();
+
+	for(auto& w : workers)
+		w.join();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task& task)
+{
+	if(count == 0)
+		return;
+
+	auto loop = std::make_shared<Loop>(count, task);
+
+	// no more helpers than there is work for them
+	const std::size_t helpers = count - 1 < workers.size() ? count - 1 : workers.size();
+
+	if(helpers)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for(std::size_t i = 0; i < helpers; ++i)
+				queue.emplace_back([loop]() { loop->run(); });
+		}
+
+		wake.notify_all();
+	}
+
+	loop->run();
+
+	// helpers may still be finishing the last few
+	{
+		std::unique_lock<std::mutex> lock(loop->mutex);
+		loop->finished.wait(lock, [&]() { return loop->done == count; });
+	}
+
+	if(loop->error)
+		std::rethrow_exception(loop->error);
+}
+
+std::size_t ThreadPool::size() const
+{
+	return workers.size() + 1;
+}
+
+ThreadPool& ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::work()
+{
+	while(true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+			if(queue.empty())
+				return;
+
+			job = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		job();
+	}
+}
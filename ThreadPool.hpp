@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a fixed set of worker threads for splitting loops up across cores
+class ThreadPool
+{
+	public:
+		using Task = std::function<void(std::size_t)>;
+
+		// "threads" is how many threads work on a loop in total, counting the one that started it
+		// 0 means one per core
+		explicit ThreadPool(std::size_t threads = 0);
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator =(const ThreadPool&) = delete;
+
+		// waits for the workers to finish what they're doing, and stops them
+		~ThreadPool();
+
+		// calls "task" once for every index in [0, count), spread across the pool, and returns once they're all done
+		// the calling thread works on them too, so calling this from inside a task is fine (it just gets fewer helpers)
+		// if any of them throw, the first exception is rethrown here, after the rest have finished
+		void parallelFor(std::size_t count, const Task& task);
+
+		// threads working on a loop, counting the caller
+		std::size_t size() const;
+
+		// shared by everything that isn't given a pool of its own, one thread per core
+		static ThreadPool& global();
+
+	private:
+		void work();
+
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<std::function<void()>> queue;
+		bool stopping;
+};
+
+#endif
@@ -0,0 +1,276 @@
+#include "TrackingAllocator.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "BitOps.hpp"
+
+namespace
+{
+	using Tracker = swift::AllocationTracker;
+
+	std::size_t bucketOf(std::size_t bytes)
+	{
+		if(bytes <= 1)
+			return 0;
+
+		// log2 of "bytes", rounded up
+		const std::size_t bucket = dbr::impl::highestBit(bytes - 1) + 1;
+		return bucket < Tracker::histogramBuckets ? bucket : Tracker::histogramBuckets - 1;
+	}
+
+	// only ever written by the thread they belong to, so plain loads and stores are enough,
+	// they're atomic so stats() can read them from another thread
+	struct TagCounters
+	{
+		std::atomic<std::size_t> allocations;
+		std::atomic<std::size_t> deallocations;
+
+		std::atomic<std::size_t> allocatedBytes;
+		std::atomic<std::size_t> freedBytes;
+		std::atomic<std::size_t> peakBytes;
+
+		std::atomic<std::size_t> histogram[Tracker::histogramBuckets];
+	};
+
+	void bump(std::atomic<std::size_t>& counter, std::size_t amount)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	// a thread's counters. Plain data, so it's still usable after its thread has started exiting
+	// (ie: by the destructors of other thread_locals), it just stops counting into itself then
+	struct ThreadCounters
+	{
+		TagCounters tags[Tracker::maxTags];
+
+		bool registered;
+		bool exited;
+	};
+
+	thread_local ThreadCounters counters;
+
+	// tags' names, the threads that are counting, and what exited threads counted
+	struct Registry
+	{
+		std::mutex lock;
+
+		const char* names[Tracker::maxTags] = {"untagged"};
+		std::size_t tagCount = 1;
+
+		std::vector<ThreadCounters*> threads;
+		ThreadCounters retired = {};
+	};
+
+	Registry& registry()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	// folds a thread's counters into "to". "to" can't be changing at the same time
+	void fold(const ThreadCounters& from, ThreadCounters& to)
+	{
+		for(std::size_t t = 0; t < Tracker::maxTags; ++t)
+		{
+			const TagCounters& src = from.tags[t];
+			TagCounters& dst = to.tags[t];
+
+			bump(dst.allocations, src.allocations.load(std::memory_order_relaxed));
+			bump(dst.deallocations, src.deallocations.load(std::memory_order_relaxed));
+			bump(dst.allocatedBytes, src.allocatedBytes.load(std::memory_order_relaxed));
+			bump(dst.freedBytes, src.freedBytes.load(std::memory_order_relaxed));
+			bump(dst.peakBytes, src.peakBytes.load(std::memory_order_relaxed));
+
+			for(std::size_t b = 0; b < Tracker::histogramBuckets; ++b)
+				bump(dst.histogram[b], src.histogram[b].load(std::memory_order_relaxed));
+		}
+	}
+
+	// unregisters its thread's counters when the thread exits, keeping what they counted
+	struct Retirer
+	{
+		~Retirer()
+		{
+			Registry& reg = registry();
+			std::lock_guard<std::mutex> lock(reg.lock);
+
+			fold(counters, reg.retired);
+
+			for(auto& thread : reg.threads)
+			{
+				if(thread == &counters)
+				{
+					thread = reg.threads.back();
+					reg.threads.pop_back();
+					break;
+				}
+			}
+
+			counters.exited = true;
+		}
+	};
+
+	thread_local Retirer retirer;
+
+	// the counters for "tag" the calling thread should count into: its own, or once it's exiting,
+	// the retired ones, with "lock" holding the registry's lock
+	TagCounters& countersFor(Tracker::Tag tag, std::unique_lock<std::mutex>& lock)
+	{
+		if(counters.exited)
+		{
+			Registry& reg = registry();
+			lock = std::unique_lock<std::mutex>(reg.lock);
+			return reg.retired.tags[tag];
+		}
+
+		// using the Retirer is what makes it retire these counters when this thread exits
+		if(!counters.registered)
+		{
+			static_cast<void>(&retirer);
+			counters.registered = true;
+
+			Registry& reg = registry();
+			std::lock_guard<std::mutex> registering(reg.lock);
+			reg.threads.push_back(&counters);
+		}
+
+		return counters.tags[tag];
+	}
+}
+
+namespace swift
+{
+	constexpr std::size_t AllocationTracker::maxTags;
+	constexpr std::size_t AllocationTracker::histogramBuckets;
+	constexpr AllocationTracker::Tag AllocationTracker::untagged;
+
+	AllocationTracker::Tag AllocationTracker::tag(const char* name)
+	{
+#if SWIFT_TRACK_ALLOCATIONS
+		Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.lock);
+
+		// by contents, since the same literal can have different addresses in different translation units
+		for(std::size_t t = 0; t < reg.tagCount; ++t)
+		{
+			if(std::strcmp(reg.names[t], name) == 0)
+				return static_cast<Tag>(t);
+		}
+
+		if(reg.tagCount == maxTags)
+			return untagged;
+
+		reg.names[reg.tagCount] = name;
+		return static_cast<Tag>(reg.tagCount++);
+#else
+		static_cast<void>(name);
+		return untagged;
+#endif
+	}
+
+	void AllocationTracker::recordAllocate(Tag tag, std::size_t bytes)
+	{
+		std::unique_lock<std::mutex> lock;
+		TagCounters& count = countersFor(tag, lock);
+
+		bump(count.allocations, 1);
+		bump(count.allocatedBytes, bytes);
+		bump(count.histogram[bucketOf(bytes)], 1);
+
+		// wraps around if this thread's freed more than it's allocated, so compared as signed
+		const std::size_t net = count.allocatedBytes.load(std::memory_order_relaxed) - count.freedBytes.load(std::memory_order_relaxed);
+		if(static_cast<std::ptrdiff_t>(net) > static_cast<std::ptrdiff_t>(count.peakBytes.load(std::memory_order_relaxed)))
+			count.peakBytes.store(net, std::memory_order_relaxed);
+	}
+
+	void AllocationTracker::recordDeallocate(Tag tag, std::size_t bytes)
+	{
+		std::unique_lock<std::mutex> lock;
+		TagCounters& count = countersFor(tag, lock);
+
+		bump(count.deallocations, 1);
+		bump(count.freedBytes, bytes);
+	}
+
+	std::vector<AllocationTracker::TagStats> AllocationTracker::stats()
+	{
+		std::vector<TagStats> result;
+
+#if SWIFT_TRACK_ALLOCATIONS
+		Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.lock);
+
+		ThreadCounters total = {};
+		fold(reg.retired, total);
+
+		for(auto* thread : reg.threads)
+			fold(*thread, total);
+
+		result.resize(reg.tagCount);
+
+		for(std::size_t t = 0; t < reg.tagCount; ++t)
+		{
+			const TagCounters& count = total.tags[t];
+			TagStats& stats = result[t];
+
+			stats.name = reg.names[t];
+			stats.allocations = count.allocations.load(std::memory_order_relaxed);
+			stats.deallocations = count.deallocations.load(std::memory_order_relaxed);
+
+			// a thread's frees can be read before the allocations they free, on another thread
+			const std::size_t allocated = count.allocatedBytes.load(std::memory_order_relaxed);
+			const std::size_t freed = count.freedBytes.load(std::memory_order_relaxed);
+
+			stats.liveBytes = allocated > freed ? allocated - freed : 0;
+			stats.totalBytes = allocated;
+			stats.peakBytes = count.peakBytes.load(std::memory_order_relaxed);
+
+			for(std::size_t b = 0; b < histogramBuckets; ++b)
+				stats.histogram[b] = count.histogram[b].load(std::memory_order_relaxed);
+		}
+#endif
+
+		return result;
+	}
+
+	void AllocationTracker::dump(std::ostream& os)
+	{
+		const std::vector<TagStats> all = stats();
+
+		os << "{\"enabled\":" << (SWIFT_TRACK_ALLOCATIONS ? "true" : "false") << ",\"histogramBuckets\":" << histogramBuckets << ",\"tags\":[";
+
+		for(std::size_t t = 0; t < all.size(); ++t)
+		{
+			const TagStats& stats = all[t];
+
+			if(t != 0)
+				os << ',';
+
+			os << "{\"name\":\"";
+
+			for(const char* c = stats.name; *c; ++c)
+			{
+				if(*c == '"' || *c == '\\')
+					os << '\\';
+
+				os << *c;
+			}
+
+			os << "\",\"allocations\":" << stats.allocations
+			   << ",\"deallocations\":" << stats.deallocations
+			   << ",\"liveBytes\":" << stats.liveBytes
+			   << ",\"peakBytes\":" << stats.peakBytes
+			   << ",\"totalBytes\":" << stats.totalBytes
+			   << ",\"histogram\":[";
+
+			for(std::size_t b = 0; b < histogramBuckets; ++b)
+				os << (b != 0 ? "," : "") << stats.histogram[b];
+
+			os << "]}";
+		}
+
+		os << "]}";
+	}
+}
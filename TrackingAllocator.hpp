@@ -0,0 +1,231 @@
+#ifndef TRACKING_ALLOCATOR_HPP
+#define TRACKING_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+// define as 1 (for every translation unit) to turn tracking on
+// otherwise TrackingAllocator just forwards to the allocator it wraps, and AllocationTracker reports nothing
+#ifndef SWIFT_TRACK_ALLOCATIONS
+#	define SWIFT_TRACK_ALLOCATIONS 0
+#endif
+
+namespace swift
+{
+	// counts what TrackingAllocators allocate, per tag: usually one per kind of container, or per call site
+	// each thread counts into its own counters, without any locking or atomic read-modify-writes,
+	// and they're only added up when asked for. A thread's counters are folded into the totals when it exits
+	class AllocationTracker
+	{
+		public:
+			static constexpr std::size_t maxTags = 32;
+
+			// bucket i counts allocations of (2^(i - 1), 2^i] bytes. The first one also counts 0 byte ones,
+			// and the last everything bigger
+			static constexpr std::size_t histogramBuckets = 32;
+
+			using Tag = std::uint32_t;
+
+			// for anything not tagged, and every name past maxTags
+			static constexpr Tag untagged = 0;
+
+			struct TagStats
+			{
+				const char* name;
+
+				std::size_t allocations;
+				std::size_t deallocations;
+
+				// live bytes now, and all bytes ever allocated
+				std::size_t liveBytes;
+				std::size_t totalBytes;
+
+				// the sum of each thread's peak of what it allocated less what it freed, so an upper bound
+				// exact if everything is freed on the thread that allocated it, and all of it on one thread
+				std::size_t peakBytes;
+
+				std::size_t histogram[histogramBuckets];
+			};
+
+			// the tag called "name", registered the first time it's asked for. Takes a lock, so best done once, ie:
+			// static const auto tag = swift::AllocationTracker::tag("QuadTree");
+			// "name" has to outlive the tracker (ie: a string literal)
+			static Tag tag(const char* name);
+
+			static void recordAllocate(Tag tag, std::size_t bytes);
+			static void recordDeallocate(Tag tag, std::size_t bytes);
+
+			// every registered tag, untagged first. Other threads may be allocating while this adds things up,
+			// so it's not a consistent snapshot of every tag at once
+			static std::vector<TagStats> stats();
+
+			// stats() as JSON:
+			// {"enabled":true,"histogramBuckets":32,"tags":[{"name":"...","allocations":0,...,"histogram":[...]},...]}
+			static void dump(std::ostream& os);
+	};
+
+	// wraps "Alloc" (any allocator: std::allocator, swift::ArenaAllocator, swift::PoolAllocator, ...),
+	// counting everything allocated through it against a tag (ie: DynArray<T, swift::TrackingAllocator<T>>)
+	// allocate_at_least() and reallocate() are there if "Alloc" has them
+	// copies and rebinds keep the tag. Comparing them only compares the wrapped allocators,
+	// so a container can end up freeing a block that was counted against another's tag
+	template<typename T, typename Alloc = std::allocator<T>>
+	class TrackingAllocator
+	{
+		using Traits = std::allocator_traits<Alloc>;
+
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			template<typename U>
+			struct rebind
+			{
+				using other = TrackingAllocator<U, typename Traits::template rebind_alloc<U>>;
+			};
+
+			explicit TrackingAllocator(AllocationTracker::Tag tag = AllocationTracker::untagged, const Alloc& alloc = Alloc());
+
+			template<typename U, typename AllocU>
+			TrackingAllocator(const TrackingAllocator<U, AllocU>& other);
+
+			pointer allocate(size_type n);
+
+			template<typename A = Alloc>
+			auto allocate_at_least(size_type n) -> decltype(std::declval<A&>().allocate_at_least(n));
+
+			// counted as freeing the old block and allocating the new one
+			template<typename A = Alloc>
+			auto reallocate(pointer ptr, size_type oldCount, size_type newCount) -> decltype(std::declval<A&>().reallocate(ptr, oldCount, newCount));
+
+			void deallocate(pointer ptr, size_type n);
+
+			AllocationTracker::Tag tag() const;
+
+			const Alloc& inner() const;
+
+			template<typename U, typename AllocU, typename V, typename AllocV>
+			friend bool operator ==(const TrackingAllocator<U, AllocU>&, const TrackingAllocator<V, AllocV>&);
+
+			template<typename U, typename AllocU, typename V, typename AllocV>
+			friend bool operator !=(const TrackingAllocator<U, AllocU>&, const TrackingAllocator<V, AllocV>&);
+
+		private:
+			template<typename U, typename AllocU>
+			friend class TrackingAllocator;
+
+			Alloc wrapped;
+
+#if SWIFT_TRACK_ALLOCATIONS
+			AllocationTracker::Tag tagId;
+#endif
+	};
+
+	template<typename T, typename Alloc>
+	TrackingAllocator<T, Alloc>::TrackingAllocator(AllocationTracker::Tag tag, const Alloc& alloc)
+	:	wrapped(alloc)
+#if SWIFT_TRACK_ALLOCATIONS
+		, tagId(tag)
+#endif
+	{
+		static_cast<void>(tag);
+	}
+
+	template<typename T, typename Alloc>
+	template<typename U, typename AllocU>
+	TrackingAllocator<T, Alloc>::TrackingAllocator(const TrackingAllocator<U, AllocU>& other)
+	:	wrapped(other.wrapped)
+#if SWIFT_TRACK_ALLOCATIONS
+		, tagId(other.tagId)
+#endif
+	{}
+
+	template<typename T, typename Alloc>
+	typename TrackingAllocator<T, Alloc>::pointer TrackingAllocator<T, Alloc>::allocate(size_type n)
+	{
+		pointer ptr = Traits::allocate(wrapped, n);
+
+#if SWIFT_TRACK_ALLOCATIONS
+		AllocationTracker::recordAllocate(tagId, n * sizeof(T));
+#endif
+
+		return ptr;
+	}
+
+	template<typename T, typename Alloc>
+	template<typename A>
+	auto TrackingAllocator<T, Alloc>::allocate_at_least(size_type n) -> decltype(std::declval<A&>().allocate_at_least(n))
+	{
+		auto result = wrapped.allocate_at_least(n);
+
+#if SWIFT_TRACK_ALLOCATIONS
+		AllocationTracker::recordAllocate(tagId, result.count * sizeof(T));
+#endif
+
+		return result;
+	}
+
+	template<typename T, typename Alloc>
+	template<typename A>
+	auto TrackingAllocator<T, Alloc>::reallocate(pointer ptr, size_type oldCount, size_type newCount) -> decltype(std::declval<A&>().reallocate(ptr, oldCount, newCount))
+	{
+		auto result = wrapped.reallocate(ptr, oldCount, newCount);
+
+#if SWIFT_TRACK_ALLOCATIONS
+		AllocationTracker::recordDeallocate(tagId, oldCount * sizeof(T));
+		AllocationTracker::recordAllocate(tagId, newCount * sizeof(T));
+#endif
+
+		return result;
+	}
+
+	template<typename T, typename Alloc>
+	void TrackingAllocator<T, Alloc>::deallocate(pointer ptr, size_type n)
+	{
+#if SWIFT_TRACK_ALLOCATIONS
+		if(ptr)
+			AllocationTracker::recordDeallocate(tagId, n * sizeof(T));
+#endif
+
+		Traits::deallocate(wrapped, ptr, n);
+	}
+
+	template<typename T, typename Alloc>
+	AllocationTracker::Tag TrackingAllocator<T, Alloc>::tag() const
+	{
+#if SWIFT_TRACK_ALLOCATIONS
+		return tagId;
+#else
+		return AllocationTracker::untagged;
+#endif
+	}
+
+	template<typename T, typename Alloc>
+	const Alloc& TrackingAllocator<T, Alloc>::inner() const
+	{
+		return wrapped;
+	}
+
+	template<typename U, typename AllocU, typename V, typename AllocV>
+	bool operator ==(const TrackingAllocator<U, AllocU>& lhs, const TrackingAllocator<V, AllocV>& rhs)
+	{
+		return lhs.wrapped == rhs.wrapped;
+	}
+
+	template<typename U, typename AllocU, typename V, typename AllocV>
+	bool operator !=(const TrackingAllocator<U, AllocU>& lhs, const TrackingAllocator<V, AllocV>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "ConcurrentDynArray.hpp"
+#include "DynArray.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// appends from 1 to N threads at once (N is the hardware's thread count, or the first argument), into:
+// - a ConcurrentDynArray
+// - a DynArray behind a std::mutex, which is what ConcurrentDynArray is meant to replace
+// every thread appends the same number of elements, so the total grows with the thread count
+// and perfect scaling is a flat time, or a throughput that grows with the threads
+
+namespace
+{
+	constexpr std::size_t perThread = 2000000;
+
+	// a result record, as a worker might append
+	struct Result
+	{
+		std::size_t worker;
+		std::size_t item;
+		double value;
+	};
+
+	// the best of a few runs of "fn", in seconds
+	template<typename Fn>
+	double bestOf(int runs, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// runs "work(worker)" on "threads" threads at once, and waits for all of them
+	template<typename Work>
+	void onThreads(std::size_t threads, Work work)
+	{
+		std::vector<std::thread> workers;
+
+		for(std::size_t t = 0; t < threads; ++t)
+			workers.emplace_back(work, t);
+
+		for(auto& worker : workers)
+			worker.join();
+	}
+
+	double concurrent(std::size_t threads)
+	{
+		return bestOf(3, [threads]
+		{
+			ConcurrentDynArray<Result> results;
+
+			onThreads(threads, [&results](std::size_t worker)
+			{
+				for(std::size_t i = 0; i < perThread; ++i)
+					results.push_back({worker, i, 0.5 * i});
+			});
+
+			if(results.size() != threads * perThread)
+				std::abort();
+		});
+	}
+
+	double locked(std::size_t threads)
+	{
+		return bestOf(3, [threads]
+		{
+			DynArray<Result> results;
+			std::mutex lock;
+
+			onThreads(threads, [&results, &lock](std::size_t worker)
+			{
+				for(std::size_t i = 0; i < perThread; ++i)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					results.push_back({worker, i, 0.5 * i});
+				}
+			});
+
+			if(results.size() != threads * perThread)
+				std::abort();
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	maxThreads = std::max<std::size_t>(maxThreads, 1);
+
+	std::printf("%zu appends per thread, best of 3, %u hardware threads\n", perThread, std::thread::hardware_concurrency());
+	std::printf("  threads   ConcurrentDynArray          DynArray + mutex\n");
+
+	// powers of two, and the most
+	std::vector<std::size_t> counts;
+	for(std::size_t threads = 1; threads < maxThreads; threads *= 2)
+		counts.push_back(threads);
+
+	counts.push_back(maxThreads);
+
+	for(std::size_t threads : counts)
+	{
+		const double total = static_cast<double>(threads * perThread);
+
+		const double lockFree = concurrent(threads);
+		const double mutex = locked(threads);
+
+		std::printf("  %7zu   %7.3f s  %7.1f M/s   %7.3f s  %7.1f M/s\n", threads, lockFree, total / lockFree / 1e6, mutex, total / mutex / 1e6);
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "DynArray.hpp"
+
+#ifdef __linux__
+#	include "MappedDynArray.hpp"
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// times filling arrays of trivially copyable records one push_back at a time, so most of the cost is growing:
+// - DynArray, moving its elements to each new block with one memcpy
+// - DynArray, made to move them one at a time (the same record, with is_trivially_relocatable turned off)
+// - DynArray over anonymous mappings, growing them in place with mremap (Linux only)
+// - std::vector
+
+namespace
+{
+	// a typical small record
+	struct Record
+	{
+		std::uint64_t id;
+		double x;
+		double y;
+		std::uint32_t flags;
+		std::uint32_t count;
+	};
+
+	// the same record, without the bulk copy
+	struct ElementWise : Record
+	{};
+}
+
+namespace dbr
+{
+	template<>
+	struct is_trivially_relocatable<ElementWise> : std::false_type
+	{};
+}
+
+namespace
+{
+	// keeps results from being optimized away
+	volatile std::uint64_t sink;
+
+	// the best of a few runs of "fn", in nanoseconds
+	template<typename Fn>
+	double bestOf(int runs, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// nanoseconds per element, filling enough arrays of "n" to add up to 10M or so elements per run
+	template<typename Array>
+	double fill(std::size_t n)
+	{
+		const std::size_t arrays = n < 10000000 ? 10000000 / n : 1;
+
+		const double ns = bestOf(5, [n, arrays]
+		{
+			for(std::size_t a = 0; a < arrays; ++a)
+			{
+				Array array;
+
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					typename Array::value_type record;
+					record.id = i;
+					record.x = 0;
+					record.y = 0;
+					record.flags = 0;
+					record.count = 0;
+
+					array.push_back(record);
+				}
+
+				sink = array[n / 2].id;
+			}
+		});
+
+		return ns / (arrays * n);
+	}
+
+	void report(const char* name, double ns, double baseline)
+	{
+		std::printf("  %-32s %7.2f ns/element  %5.2fx\n", name, ns, baseline / ns);
+	}
+}
+
+int main()
+{
+	const std::size_t sizes[] = {1000, 100000, 10000000};
+
+	std::printf("push_back of %zu byte records, best of 5 (speedup is over the element-wise DynArray)\n", sizeof(Record));
+
+	for(std::size_t n : sizes)
+	{
+		std::printf("%zu elements\n", n);
+
+		const double elementWise = fill<DynArray<ElementWise>>(n);
+
+		report("DynArray, element-wise", elementWise, elementWise);
+		report("DynArray, bulk copy", fill<DynArray<Record>>(n), elementWise);
+#ifdef __linux__
+		report("DynArray, mremap", fill<DynArray<Record, MappedFileAllocator<Record>>>(n), elementWise);
+#endif
+		report("std::vector", fill<std::vector<Record>>(n), elementWise);
+	}
+
+	return 0;
+}
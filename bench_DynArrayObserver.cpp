@@ -0,0 +1,108 @@
+#include "DynArray.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+// what a DynArray's reallocation observer costs: its size, and push_back throughput with each observer
+// dbr::observe::Callback is the old std::function callback, kept as an observer
+
+namespace
+{
+	template<typename Observer>
+	using Array = DynArray<int, std::allocator<int>, dbr::growth::Double, Observer>;
+
+	// keeps results from being optimized away
+	volatile std::size_t sink;
+
+	// the best of a few runs of "fn", in nanoseconds
+	template<typename Fn>
+	double bestOf(int runs, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// nanoseconds per push_back into lots of small arrays, so reallocations (and so observer calls) are frequent
+	template<typename Observer, typename Setup>
+	double pushBacks(Setup setup)
+	{
+		constexpr std::size_t arrays = 100000;
+		constexpr std::size_t perArray = 100;
+
+		const double ns = bestOf(5, [setup]
+		{
+			for(std::size_t a = 0; a < arrays; ++a)
+			{
+				Array<Observer> array;
+				setup(array);
+
+				for(std::size_t i = 0; i < perArray; ++i)
+					array.push_back(static_cast<int>(i));
+
+				sink = array.size();
+			}
+		});
+
+		return ns / (arrays * perArray);
+	}
+
+	void report(const char* name, std::size_t size, double ns, double baseline)
+	{
+		std::printf("  %-36s %3zu bytes  %6.2f ns/push_back  %5.2fx\n", name, size, ns, ns / baseline);
+	}
+}
+
+int main()
+{
+	std::size_t calls = 0;
+
+	const auto nothing = [](auto&) {};
+
+	const double none = pushBacks<dbr::observe::None>(nothing);
+	const double stats = pushBacks<dbr::observe::Stats>(nothing);
+	const double unset = pushBacks<dbr::observe::Callback<int>>(nothing);
+	const double set = pushBacks<dbr::observe::Callback<int>>([&calls](auto& array)
+	{
+		array.setCallback([&calls](const int*, std::size_t) { ++calls; });
+	});
+
+	// a user functor, inlined
+	struct Counting
+	{
+		std::size_t* calls;
+
+		void operator ()(const int*, std::size_t, const dbr::MoveEvent&)
+		{
+			++*calls;
+		}
+	};
+
+	const double functor = pushBacks<Counting>([&calls](auto& array)
+	{
+		array.observer().calls = &calls;
+	});
+
+	sink = calls;
+
+	std::printf("DynArray<int> by observer, 100 push_backs into each of 100K arrays, best of 5 (relative to None)\n");
+	report("None (default)", sizeof(Array<dbr::observe::None>), none, none);
+	report("Stats", sizeof(Array<dbr::observe::Stats>), stats, none);
+	report("counting functor", sizeof(Array<Counting>), functor, none);
+	report("Callback (std::function), unset", sizeof(Array<dbr::observe::Callback<int>>), unset, none);
+	report("Callback (std::function), set", sizeof(Array<dbr::observe::Callback<int>>), set, none);
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include "FlatMap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// builds a FlatMap, a std::map and a std::unordered_map of random 64 bit keys, in bulk, then times random lookups
+// of keys that are there (hits) and keys that aren't (misses), at 1K, 1M, and the first argument's entries (10M by default)
+// 100M entries needs 6 GB or more at once (the input, plus the std::map), so it has to be asked for
+
+namespace
+{
+	using Key = std::uint64_t;
+	using Value = std::uint64_t;
+
+	constexpr std::size_t lookups = 2000000;
+
+	// keeps results from being optimized away
+	volatile Value sink;
+
+	// the best of a few runs of "fn", in nanoseconds
+	template<typename Fn>
+	double bestOf(int runs, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// nanoseconds per lookup of "keys", "find" returning a pointer to the value, or null
+	template<typename Find>
+	double lookupNs(const std::vector<Key>& keys, Find find)
+	{
+		const double ns = bestOf(3, [&keys, &find]
+		{
+			Value total = 0;
+
+			for(Key key : keys)
+			{
+				const Value* value = find(key);
+				total += value ? *value : 1;
+			}
+
+			sink = total;
+		});
+
+		return ns / keys.size();
+	}
+
+	void report(const char* name, double build, double hit, double miss)
+	{
+		std::printf("  %-20s build %9.1f ms   hit %7.1f ns   miss %7.1f ns\n", name, build / 1e6, hit, miss);
+	}
+
+	template<typename Map, typename Build, typename Find>
+	void measure(const char* name, Build build, Find find, const std::vector<Key>& hits, const std::vector<Key>& misses)
+	{
+		Map map;
+
+		// built once to look things up in, timed separately (construction is what's being measured, so not best of)
+		const auto start = std::chrono::steady_clock::now();
+		build(map);
+		const std::chrono::duration<double, std::nano> built = std::chrono::steady_clock::now() - start;
+
+		const auto lookup = [&map, &find](Key key) { return find(map, key); };
+
+		report(name, built.count(), lookupNs(hits, lookup), lookupNs(misses, lookup));
+	}
+
+	void run(std::size_t entries, std::mt19937_64& rng)
+	{
+		// keys are even, so any odd key is a miss
+		std::vector<std::pair<Key, Value>> items(entries);
+		for(std::size_t i = 0; i < entries; ++i)
+			items[i] = {rng() & ~Key{1}, i};
+
+		std::uniform_int_distribution<std::size_t> pick(0, entries - 1);
+
+		std::vector<Key> hits(lookups);
+		for(auto& key : hits)
+			key = items[pick(rng)].first;
+
+		std::vector<Key> misses(lookups);
+		for(auto& key : misses)
+			key = rng() | 1;
+
+		std::printf("%zu entries\n", entries);
+
+		measure<FlatMap<Key, Value>>("FlatMap",
+			[&items](FlatMap<Key, Value>& map) { map.assign(items.begin(), items.end()); },
+			[](FlatMap<Key, Value>& map, Key key) -> const Value* { return map.find(key); },
+			hits, misses);
+
+		measure<std::map<Key, Value>>("std::map",
+			[&items](std::map<Key, Value>& map) { map.insert(items.begin(), items.end()); },
+			[](std::map<Key, Value>& map, Key key) -> const Value*
+			{
+				const auto it = map.find(key);
+				return it != map.end() ? &it->second : nullptr;
+			},
+			hits, misses);
+
+		measure<std::unordered_map<Key, Value>>("std::unordered_map",
+			[&items, entries](std::unordered_map<Key, Value>& map)
+			{
+				map.reserve(entries);
+				map.insert(items.begin(), items.end());
+			},
+			[](std::unordered_map<Key, Value>& map, Key key) -> const Value*
+			{
+				const auto it = map.find(key);
+				return it != map.end() ? &it->second : nullptr;
+			},
+			hits, misses);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t largest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+	std::mt19937_64 rng(42);
+
+	std::printf("%zu random lookups each of hits and misses, best of 3\n", lookups);
+
+	const std::size_t sizes[] = {1000, 1000000, largest};
+	for(std::size_t entries : sizes)
+		run(entries, rng);
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "ParallelAlgorithms.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// the speedup curve of dbr::parallel's algorithms over their serial std:: counterparts, on a pool of 1 to N threads
+// (N is the hardware's thread count, or the first argument), over an array of "count" doubles (the second argument)
+
+namespace
+{
+	// keeps results from being optimized away
+	volatile double sink;
+
+	// the best of a few runs of "fn", in milliseconds. "setup" runs before each, untimed
+	template<typename Setup, typename Fn>
+	double bestOf(int runs, Setup setup, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			setup();
+
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// the same work for both sides of each comparison: cheap enough that memory bandwidth matters
+	double work(double x)
+	{
+		return std::sqrt(x) * 1.5 + 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	maxThreads = std::max<std::size_t>(maxThreads, 1);
+
+	const std::size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000000;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> values(0, 1000);
+
+	DynArray<double> source(count);
+	for(std::size_t i = 0; i < count; ++i)
+		source.push_back(values(rng));
+
+	DynArray<double> array;
+	DynArray<double> out;
+	const auto none = [] {};
+	const auto fresh = [&] { array = source; };
+
+	// serial baselines
+	const double forEach = bestOf(3, fresh, [&] { std::for_each(array.begin(), array.end(), [](double& x) { x = work(x); }); });
+
+	const double transform = bestOf(3, [&] { out.clear(); }, [&]
+	{
+		out.reserve(count);
+		for(std::size_t i = 0; i < count; ++i)
+			out.push_back(work(source[i]));
+	});
+
+	const double reduce = bestOf(3, none, [&] { sink = std::accumulate(source.begin(), source.end(), 0.0); });
+
+	const double scan = bestOf(3, [&] { out.clear(); }, [&]
+	{
+		out.reserve(count);
+		double total = 0;
+		for(std::size_t i = 0; i < count; ++i)
+			out.push_back(total += source[i]);
+	});
+
+	const double sort = bestOf(3, fresh, [&] { std::sort(array.begin(), array.end()); });
+
+	std::printf("%zu doubles, best of 3, %u hardware threads\n", count, std::thread::hardware_concurrency());
+	std::printf("  serial ms:  for_each %8.2f  transform %8.2f  reduce %8.2f  scan %8.2f  sort %8.2f\n",
+	            forEach, transform, reduce, scan, sort);
+	std::printf("  speedup over serial\n");
+	std::printf("  threads   for_each  transform   reduce     scan     sort\n");
+
+	// powers of two, and the most
+	std::vector<std::size_t> counts;
+	for(std::size_t threads = 1; threads < maxThreads; threads *= 2)
+		counts.push_back(threads);
+
+	counts.push_back(maxThreads);
+
+	for(std::size_t threads : counts)
+	{
+		ThreadPool pool(threads);
+
+		const double pForEach = bestOf(3, fresh, [&] { dbr::parallel::for_each(array, [](double& x) { x = work(x); }, pool); });
+		const double pTransform = bestOf(3, [&] { out.clear(); }, [&] { dbr::parallel::transform(source, out, work, pool); });
+		const double pReduce = bestOf(3, none, [&] { sink = dbr::parallel::reduce(source, 0.0, std::plus<double>(), pool); });
+		const double pScan = bestOf(3, [&] { out.clear(); }, [&] { dbr::parallel::inclusive_scan(source, out, std::plus<double>(), pool); });
+		const double pSort = bestOf(3, fresh, [&] { dbr::parallel::sort(array, std::less<double>(), pool); });
+
+		std::printf("  %7zu   %7.2fx   %7.2fx  %7.2fx  %7.2fx  %7.2fx\n", threads,
+		            forEach / pForEach, transform / pTransform, reduce / pReduce, scan / pScan, sort / pSort);
+	}
+
+	return 0;
+}
@@ -0,0 +1,230 @@
+#include "SimdAlgorithms.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+// checks dbr::simd's kernels against the scalar ones they replace, then times both in GB/s
+// every kernel this build has is checked directly (SSE2, and AVX2 if the CPU has it), not just the one picked at runtime,
+// over every length up to a few vectors (so every tail length), and a long one. Exits with 1 if anything's off
+
+namespace
+{
+	namespace impl = dbr::simd::impl;
+
+	std::size_t failures = 0;
+
+	void check(bool ok, const char* what, const char* type, std::size_t n)
+	{
+		if(!ok)
+		{
+			std::printf("FAILED: %s<%s>, n = %zu\n", what, type, n);
+			++failures;
+		}
+	}
+
+	// sums of floats are added up in a different order, so they only have to be within both orders' rounding error:
+	// "magnitude" (the sum of the terms' absolute values) * n * epsilon, each
+	bool close(float simd, float scalar, double magnitude, std::size_t n)
+	{
+		return std::fabs(static_cast<double>(simd) - scalar) <= 2 * magnitude * n * std::numeric_limits<float>::epsilon();
+	}
+
+	bool close(std::int32_t simd, std::int32_t scalar, double, std::size_t)
+	{
+		return simd == scalar;
+	}
+
+	// small whole numbers, so there are repeats to find and count, and float sums are exact more often than not
+	template<typename T>
+	std::vector<T> randomData(std::size_t n, std::mt19937& rng)
+	{
+		std::uniform_int_distribution<int> values(-1000, 1000);
+
+		std::vector<T> data(n);
+		for(auto& v : data)
+			v = static_cast<T>(values(rng));
+
+		return data;
+	}
+
+	// one set of kernels (ie: the SSE2 ones) against the scalar templates
+	template<typename T, typename Find, typename Count, typename Min, typename Max, typename Sum, typename Dot>
+	void checkKernels(const char* type, const std::vector<T>& lhs, const std::vector<T>& rhs, Find find, Count count, Min min, Max max, Sum sum, Dot dot)
+	{
+		const std::size_t n = lhs.size();
+		const T* data = lhs.data();
+
+		// the last element, one that's there several times (probably), and one that isn't there at all
+		const T needles[] = {n ? data[n - 1] : T(0), T(7), T(5000)};
+
+		for(T needle : needles)
+		{
+			check(find(data, n, needle) == impl::find<T>(data, n, needle), "find", type, n);
+			check(count(data, n, needle) == impl::count<T>(data, n, needle), "count", type, n);
+		}
+
+		if(n)
+		{
+			check(min(data, n) == impl::min<T>(data, n), "min", type, n);
+			check(max(data, n) == impl::max<T>(data, n), "max", type, n);
+		}
+
+		double sumMagnitude = 0;
+		double dotMagnitude = 0;
+
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			sumMagnitude += std::fabs(static_cast<double>(lhs[i]));
+			dotMagnitude += std::fabs(static_cast<double>(lhs[i]) * rhs[i]);
+		}
+
+		check(close(sum(data, n), impl::sum<T>(data, n), sumMagnitude, n), "sum", type, n);
+		check(close(dot(data, rhs.data(), n), impl::dot<T>(data, rhs.data(), n), dotMagnitude, n), "dot", type, n);
+	}
+
+#if DBR_SIMD_X86
+	// SSE2 has no 32 bit integer multiply, so int32 dot products stay scalar without AVX2
+	std::int32_t dotSSE2(const std::int32_t* lhs, const std::int32_t* rhs, std::size_t n)
+	{
+		return impl::dot<std::int32_t>(lhs, rhs, n);
+	}
+
+	float dotSSE2(const float* lhs, const float* rhs, std::size_t n)
+	{
+		return impl::dotSSE2(lhs, rhs, n);
+	}
+#endif
+
+	template<typename T>
+	void checkAll(const char* type, std::size_t n, std::mt19937& rng)
+	{
+		const std::vector<T> lhs = randomData<T>(n, rng);
+		const std::vector<T> rhs = randomData<T>(n, rng);
+
+		using Data = const T*;
+
+		// whichever kernel the public functions pick
+		checkKernels(type, lhs, rhs,
+			[](Data d, std::size_t n, T v) { return impl::find(d, n, v); },
+			[](Data d, std::size_t n, T v) { return impl::count(d, n, v); },
+			[](Data d, std::size_t n) { return impl::min(d, n); },
+			[](Data d, std::size_t n) { return impl::max(d, n); },
+			[](Data d, std::size_t n) { return impl::sum(d, n); },
+			[](Data l, Data r, std::size_t n) { return impl::dot(l, r, n); });
+
+#if DBR_SIMD_X86
+		checkKernels(type, lhs, rhs,
+			[](Data d, std::size_t n, T v) { return impl::findSSE2(d, n, v); },
+			[](Data d, std::size_t n, T v) { return impl::countSSE2(d, n, v); },
+			[](Data d, std::size_t n) { return impl::minSSE2(d, n); },
+			[](Data d, std::size_t n) { return impl::maxSSE2(d, n); },
+			[](Data d, std::size_t n) { return impl::sumSSE2(d, n); },
+			[](Data l, Data r, std::size_t n) { return dotSSE2(l, r, n); });
+
+		if(impl::hasAVX2())
+		{
+			checkKernels(type, lhs, rhs,
+				[](Data d, std::size_t n, T v) { return impl::findAVX2(d, n, v); },
+				[](Data d, std::size_t n, T v) { return impl::countAVX2(d, n, v); },
+				[](Data d, std::size_t n) { return impl::minAVX2(d, n); },
+				[](Data d, std::size_t n) { return impl::maxAVX2(d, n); },
+				[](Data d, std::size_t n) { return impl::sumAVX2(d, n); },
+				[](Data l, Data r, std::size_t n) { return impl::dotAVX2(l, r, n); });
+		}
+#endif
+	}
+
+	// keeps results from being optimized away
+	volatile double sink;
+
+	// GB/s of reading "bytes", "reps" times over
+	template<typename Fn>
+	double gbPerSecond(std::size_t bytes, std::size_t reps, Fn fn)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for(std::size_t r = 0; r < reps; ++r)
+			sink = static_cast<double>(fn());
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return static_cast<double>(bytes) * reps / elapsed.count() / 1e9;
+	}
+
+	template<typename T>
+	void benchmark(const char* type, std::mt19937& rng)
+	{
+		// 16 MiB per array: bigger than most L2s, so it's mostly a measure of how close to memory bandwidth each gets
+		constexpr std::size_t n = 4 * 1024 * 1024;
+		constexpr std::size_t reps = 20;
+
+		const std::vector<T> lhs = randomData<T>(n, rng);
+		const std::vector<T> rhs = randomData<T>(n, rng);
+
+		const T* l = lhs.data();
+		const T* r = rhs.data();
+		const std::size_t bytes = n * sizeof(T);
+
+		const auto report = [type](const char* what, double scalar, double simd)
+		{
+			std::printf("  %-6s<%s>  scalar %6.2f GB/s   simd %6.2f GB/s   (%.2fx)\n", what, type, scalar, simd, simd / scalar);
+		};
+
+		report("find", gbPerSecond(bytes, reps, [=] { return impl::find<T>(l, n, T(5000)); }),
+		               gbPerSecond(bytes, reps, [=] { return impl::find(l, n, T(5000)); }));
+
+		report("count", gbPerSecond(bytes, reps, [=] { return impl::count<T>(l, n, T(7)); }),
+		                gbPerSecond(bytes, reps, [=] { return impl::count(l, n, T(7)); }));
+
+		report("min", gbPerSecond(bytes, reps, [=] { return impl::min<T>(l, n); }),
+		              gbPerSecond(bytes, reps, [=] { return impl::min(l, n); }));
+
+		report("max", gbPerSecond(bytes, reps, [=] { return impl::max<T>(l, n); }),
+		              gbPerSecond(bytes, reps, [=] { return impl::max(l, n); }));
+
+		report("sum", gbPerSecond(bytes, reps, [=] { return impl::sum<T>(l, n); }),
+		              gbPerSecond(bytes, reps, [=] { return impl::sum(l, n); }));
+
+		// reads both arrays
+		report("dot", gbPerSecond(2 * bytes, reps, [=] { return impl::dot<T>(l, r, n); }),
+		              gbPerSecond(2 * bytes, reps, [=] { return impl::dot(l, r, n); }));
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(42);
+
+#if DBR_SIMD_X86
+	std::printf("SSE2 kernels, AVX2 %s\n", impl::hasAVX2() ? "too" : "not available");
+#else
+	std::printf("no SIMD kernels in this build, checking the scalar ones against themselves\n");
+#endif
+
+	for(std::size_t n = 0; n <= 40; ++n)
+	{
+		checkAll<std::int32_t>("int32", n, rng);
+		checkAll<float>("float", n, rng);
+	}
+
+	checkAll<std::int32_t>("int32", 100003, rng);
+	checkAll<float>("float", 100003, rng);
+
+	if(failures)
+	{
+		std::printf("%zu checks failed\n", failures);
+		return 1;
+	}
+
+	std::printf("all kernels match the scalar ones\n");
+
+	benchmark<std::int32_t>("int32", rng);
+	benchmark<float>("float", rng);
+
+	return 0;
+}
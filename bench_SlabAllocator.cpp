@@ -0,0 +1,155 @@
+#include "SlabAllocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#	include <malloc.h>
+#	include <unistd.h>
+#endif
+
+// runs the same mix of allocations through a SlabHeap and through malloc,
+// printing SlabHeap::stats() next to what the process and glibc's malloc say they're holding
+// the mix: mostly small objects, some medium ones, a few too big for the slabs, half of them freed in random order
+
+namespace
+{
+	constexpr std::size_t allocationCount = 200000;
+
+	// resident set size, or 0 where there's no /proc
+	std::size_t residentBytes()
+	{
+#ifdef __linux__
+		std::FILE* statm = std::fopen("/proc/self/statm", "r");
+		if(!statm)
+			return 0;
+
+		unsigned long size = 0;
+		unsigned long resident = 0;
+		const int read = std::fscanf(statm, "%lu %lu", &size, &resident);
+		std::fclose(statm);
+
+		return read == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+		return 0;
+#endif
+	}
+
+	void printMalloc(const char* when)
+	{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+		const struct mallinfo2 info = mallinfo2();
+		std::printf("  %-22s malloc: %10zu in use, %10zu free, %10zu mmapped, rss %10zu\n",
+		            when, info.uordblks, info.fordblks, info.hblkhd, residentBytes());
+#else
+		std::printf("  %-22s malloc: (no mallinfo2), rss %10zu\n", when, residentBytes());
+#endif
+	}
+
+	void printSlabs(const char* when, const swift::SlabHeap& heap)
+	{
+		const swift::SlabHeap::Stats stats = heap.stats();
+
+		std::printf("  %-22s slabs: %4zu (%10zu bytes), requested %10zu, allocated %10zu, large %zu (%zu bytes)\n",
+		            when, stats.slabs, stats.slabBytes, stats.requestedBytes, stats.allocatedBytes,
+		            stats.largeAllocations, stats.largeBytes);
+		std::printf("  %-22s internal fragmentation %5.1f%%, external %5.1f%%, rss %10zu\n",
+		            "", stats.internalFragmentation() * 100, stats.externalFragmentation() * 100, residentBytes());
+	}
+
+	// 80% 8 to 256 bytes, 18% up to 4 KiB, 2% up to 64 KiB
+	std::vector<std::size_t> sampleSizes(std::mt19937& rng)
+	{
+		std::uniform_int_distribution<int> kind(0, 99);
+		std::uniform_int_distribution<std::size_t> small(8, 256);
+		std::uniform_int_distribution<std::size_t> medium(257, 4096);
+		std::uniform_int_distribution<std::size_t> large(4097, 64 * 1024);
+
+		std::vector<std::size_t> sizes;
+		sizes.reserve(allocationCount);
+
+		for(std::size_t i = 0; i < allocationCount; ++i)
+		{
+			const int k = kind(rng);
+			sizes.push_back(k < 80 ? small(rng) : k < 98 ? medium(rng) : large(rng));
+		}
+
+		return sizes;
+	}
+
+	// every other allocation, in a random order
+	std::vector<std::size_t> halfToFree(std::mt19937& rng)
+	{
+		std::vector<std::size_t> order;
+		for(std::size_t i = 0; i < allocationCount; i += 2)
+			order.push_back(i);
+
+		std::shuffle(order.begin(), order.end(), rng);
+		return order;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(42);
+	const std::vector<std::size_t> sizes = sampleSizes(rng);
+	const std::vector<std::size_t> freeOrder = halfToFree(rng);
+
+	std::vector<void*> blocks(allocationCount);
+
+	std::printf("%zu allocations\n", allocationCount);
+	printMalloc("at start");
+
+	{
+		swift::SlabHeap heap;
+
+		std::printf("SlabHeap\n");
+
+		for(std::size_t i = 0; i < allocationCount; ++i)
+			blocks[i] = heap.allocate(sizes[i]);
+
+		printSlabs("all allocated", heap);
+
+		for(std::size_t i : freeOrder)
+		{
+			heap.deallocate(blocks[i], sizes[i]);
+			blocks[i] = nullptr;
+		}
+
+		printSlabs("half freed", heap);
+
+		for(std::size_t i = 0; i < allocationCount; ++i)
+		{
+			if(blocks[i])
+				heap.deallocate(blocks[i], sizes[i]);
+		}
+
+		printSlabs("all freed", heap);
+	}
+
+	std::printf("malloc\n");
+
+	for(std::size_t i = 0; i < allocationCount; ++i)
+		blocks[i] = std::malloc(sizes[i]);
+
+	printMalloc("all allocated");
+
+	for(std::size_t i : freeOrder)
+	{
+		std::free(blocks[i]);
+		blocks[i] = nullptr;
+	}
+
+	printMalloc("half freed");
+
+	for(std::size_t i = 0; i < allocationCount; ++i)
+		std::free(blocks[i]);
+
+	printMalloc("all freed");
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include "DynArray.hpp"
+#include "ThreadCachingAllocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// allocation churn from 1 to N threads at once (N is the hardware's thread count, or the first argument), with:
+// - std::allocator (so malloc)
+// - swift::ThreadCachingAllocator
+// every thread keeps a window of small DynArrays alive, replacing a random one with a new one of random size each step,
+// so blocks of every size class are freed about as often as they're allocated
+// every thread does the same work, so perfect scaling is a flat time, or a throughput that grows with the threads
+
+namespace
+{
+	constexpr std::size_t perThread = 1000000;
+	constexpr std::size_t window = 256;
+
+	// keeps results from being optimized away. Every thread adds to it
+	std::atomic<std::size_t> sink{0};
+
+	// the best of a few runs of "fn", in seconds
+	template<typename Fn>
+	double bestOf(int runs, Fn fn)
+	{
+		double best = 0;
+
+		for(int r = 0; r < runs; ++r)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			if(r == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+
+		return best;
+	}
+
+	// runs "work(worker)" on "threads" threads at once, and waits for all of them
+	template<typename Work>
+	void onThreads(std::size_t threads, Work work)
+	{
+		std::vector<std::thread> workers;
+
+		for(std::size_t t = 0; t < threads; ++t)
+			workers.emplace_back(work, t);
+
+		for(auto& worker : workers)
+			worker.join();
+	}
+
+	template<typename Alloc>
+	double churn(std::size_t threads)
+	{
+		using Array = DynArray<int, Alloc>;
+
+		return bestOf(3, [threads]
+		{
+			onThreads(threads, [](std::size_t worker)
+			{
+				std::mt19937 rng(static_cast<unsigned>(worker));
+
+				// mostly small, sometimes up to a few KB
+				std::uniform_int_distribution<std::size_t> sizes(1, 64);
+				std::uniform_int_distribution<std::size_t> big(1, 1024);
+				std::uniform_int_distribution<std::size_t> slot(0, window - 1);
+
+				std::vector<std::unique_ptr<Array>> live(window);
+				std::size_t total = 0;
+
+				for(std::size_t i = 0; i < perThread; ++i)
+				{
+					const std::size_t n = i % 16 == 0 ? big(rng) : sizes(rng);
+
+					auto& array = live[slot(rng)];
+					array.reset(new Array(n));
+
+					for(std::size_t j = 0; j < n; ++j)
+						array->push_back(static_cast<int>(j));
+
+					total += array->size();
+				}
+
+				sink.fetch_add(total, std::memory_order_relaxed);
+			});
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	maxThreads = std::max<std::size_t>(maxThreads, 1);
+
+	std::printf("%zu DynArray<int>s per thread, %zu alive at a time, best of 3, %u hardware threads\n",
+	            perThread, window, std::thread::hardware_concurrency());
+	std::printf("  threads   std::allocator              ThreadCachingAllocator\n");
+
+	// powers of two, and the most
+	std::vector<std::size_t> counts;
+	for(std::size_t threads = 1; threads < maxThreads; threads *= 2)
+		counts.push_back(threads);
+
+	counts.push_back(maxThreads);
+
+	for(std::size_t threads : counts)
+	{
+		const double total = static_cast<double>(threads * perThread);
+
+		const double standard = churn<std::allocator<int>>(threads);
+		const double caching = churn<swift::ThreadCachingAllocator<int>>(threads);
+
+		std::printf("  %7zu   %7.3f s  %7.1f M/s   %7.3f s  %7.1f M/s\n", threads, standard, total / standard / 1e6, caching, total / caching / 1e6);
+	}
+
+	return 0;
+}
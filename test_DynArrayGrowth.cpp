@@ -0,0 +1,274 @@
+#include "DynArray.hpp"
+#include "SmallDynArray.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// checks that a DynArray moves its elements when it grows, rather than copying them
+// a counting allocator counts the blocks asked for, and a copy counting element type counts copies, moves and live objects
+// every way of growing (back, front, the middle, reserving, resizing) has to copy nothing, free every block it allocates,
+// and leave no element behind. So does a DynArray of strings too long for their small string buffer,
+// whose characters come from the counting allocator as well: a deep copy would show up as a string allocation
+// and so do DynArrays of DynArrays and of SmallDynArrays, which only get moved if their moves can't throw
+// exits with 1 if anything's off
+
+namespace
+{
+	std::size_t failures = 0;
+
+	void check(bool ok, const char* what)
+	{
+		if(!ok)
+		{
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	struct Counts
+	{
+		std::size_t allocations = 0;
+		std::size_t deallocations = 0;
+
+		std::size_t copies = 0;
+		std::size_t moves = 0;
+		std::size_t live = 0;
+	};
+
+	Counts counts;
+
+	// std::allocator, counting
+	template<typename T>
+	class CountingAllocator
+	{
+		public:
+			using value_type = T;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using difference_type = std::ptrdiff_t;
+			using size_type = std::size_t;
+
+			template<typename U>
+			struct rebind
+			{
+				using other = CountingAllocator<U>;
+			};
+
+			CountingAllocator() = default;
+
+			template<typename U>
+			CountingAllocator(const CountingAllocator<U>&)
+			{}
+
+			T* allocate(std::size_t n)
+			{
+				++counts.allocations;
+				return std::allocator<T>().allocate(n);
+			}
+
+			void deallocate(T* ptr, std::size_t n)
+			{
+				++counts.deallocations;
+				std::allocator<T>().deallocate(ptr, n);
+			}
+
+			template<typename U>
+			bool operator ==(const CountingAllocator<U>&) const
+			{
+				return true;
+			}
+
+			template<typename U>
+			bool operator !=(const CountingAllocator<U>&) const
+			{
+				return false;
+			}
+	};
+
+	// an int that counts its copies and moves
+	class Counted
+	{
+		public:
+			explicit Counted(int value = 0)
+			:	value(value)
+			{
+				++counts.live;
+			}
+
+			Counted(const Counted& other)
+			:	value(other.value)
+			{
+				++counts.copies;
+				++counts.live;
+			}
+
+			Counted(Counted&& other) noexcept
+			:	value(other.value)
+			{
+				++counts.moves;
+				++counts.live;
+			}
+
+			Counted& operator =(const Counted& other)
+			{
+				value = other.value;
+				++counts.copies;
+				return *this;
+			}
+
+			Counted& operator =(Counted&& other) noexcept
+			{
+				value = other.value;
+				++counts.moves;
+				return *this;
+			}
+
+			~Counted()
+			{
+				--counts.live;
+			}
+
+			int value;
+	};
+
+	using String = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+	// too long for any small string buffer
+	String longString(int i)
+	{
+		return String("a string too long to be stored inline, number ") + String(std::to_string(i).c_str());
+	}
+
+	void growCounted()
+	{
+		counts = Counts();
+
+		{
+			DynArray<Counted, CountingAllocator<Counted>> array;
+
+			for(int i = 0; i < 1000; ++i)
+				array.emplace_back(i);
+
+			for(int i = 0; i < 1000; ++i)
+				array.emplace_front(-i);
+
+			for(int i = 0; i < 200; ++i)
+				array.emplace(array.begin() + array.size() / 2, i);
+
+			array.reserve(array.capacity() * 2);
+			array.reserveFront(array.frontCapacity() + 1000);
+			array.resize(array.capacity() + 1);
+
+			check(array[array.size() - 1].value == 0, "Counted: resized elements are value initialized");
+			check(counts.copies == 0, "Counted: growing copied elements");
+			check(counts.moves > 0, "Counted: growing didn't move anything (did it grow at all?)");
+		}
+
+		check(counts.live == 0, "Counted: elements left behind");
+		check(counts.allocations == counts.deallocations, "Counted: blocks leaked");
+
+		std::printf("Counted: %zu blocks, %zu moves, %zu copies\n", counts.allocations, counts.moves, counts.copies);
+	}
+
+	// grows an outer array of "Inner" arrays of Counted, so growing it moves the inner arrays
+	template<typename Inner>
+	void growNested(const char* name)
+	{
+		static_assert(std::is_nothrow_move_constructible<Inner>::value, "nested arrays have to move without throwing");
+
+		counts = Counts();
+
+		{
+			DynArray<Inner, CountingAllocator<Inner>> array;
+
+			// some inner arrays fit inside a SmallDynArray, some don't
+			for(int i = 0; i < 200; ++i)
+			{
+				array.emplace_back();
+
+				for(int j = 0; j < i % 8; ++j)
+					array.back().emplace_back(j);
+			}
+
+			for(int i = 0; i < 50; ++i)
+				array.emplace(array.begin() + array.size() / 2);
+
+			array.reserve(array.capacity() * 2);
+
+			bool intact = true;
+			for(std::size_t i = 0; i < 100; ++i)
+				for(std::size_t j = 0; j < array[i].size(); ++j)
+					intact = intact && array[i][j].value == static_cast<int>(j);
+
+			std::printf("%s: %zu copies\n", name, counts.copies);
+
+			check(intact, "nested: elements changed");
+			check(counts.copies == 0, "nested: growing copied the inner arrays' elements");
+		}
+
+		check(counts.live == 0, "nested: elements left behind");
+		check(counts.allocations == counts.deallocations, "nested: blocks leaked");
+	}
+
+	void growStrings()
+	{
+		DynArray<String, CountingAllocator<String>> array;
+
+		// strings allocate their characters when they're made, which happens outside of what's counted
+		std::size_t blocks = 0;
+		std::size_t stringAllocations = 0;
+
+		for(int i = 0; i < 1000; ++i)
+		{
+			String s = longString(i);
+			const std::size_t before = counts.allocations;
+
+			array.push_back(std::move(s));
+
+			// the only allocation push_back may make is a new block for the array
+			const std::size_t made = counts.allocations - before;
+			blocks += made > 0;
+			stringAllocations += made > 1 ? made - 1 : 0;
+		}
+
+		const std::size_t before = counts.allocations;
+
+		array.reserve(array.capacity() * 4);
+		array.reserveFront(100);
+
+		blocks += counts.allocations - before;
+		check(counts.allocations - before == 2, "String: reserving allocated more than the two blocks");
+		check(stringAllocations == 0, "String: growing deep copied strings");
+
+		bool intact = true;
+		for(int i = 0; i < 1000; ++i)
+			intact = intact && array[i] == longString(i);
+
+		check(intact, "String: strings changed");
+
+		std::printf("String: %zu blocks, %zu string allocations while growing\n", blocks, stringAllocations);
+	}
+}
+
+int main()
+{
+	growCounted();
+	growStrings();
+	growNested<DynArray<Counted, CountingAllocator<Counted>>>("DynArray<DynArray<Counted>>");
+	growNested<SmallDynArray<Counted, 4, CountingAllocator<Counted>>>("DynArray<SmallDynArray<Counted, 4>>");
+
+	if(failures)
+	{
+		std::printf("%zu checks failed\n", failures);
+		return 1;
+	}
+
+	std::printf("no element was copied while growing\n");
+	return 0;
+}